@@ -0,0 +1,245 @@
+/**
+ * Batch runner: plays many complete games across worker threads and prints
+ * the merged statistics.
+ *
+ * usage: ./batch [games] [threads] [seed] [trace.json] [--rules=NAME] [--turn-cap=N]
+ *                [--store=FILE] [--store-capacity=N] [--deck=RANKS [--suits=N] [--table=FILE]]
+ *                [--corpus=FILE] [--make-corpus=FILE [--stratify=PROPERTY] [--ranks]]
+ * the trace file is only written when built with `make TRACE=1`. NAME is one
+ * of classic (the default), acehigh, facedown2, facedown3, reshuffle and
+ * recycle; the turn cap only applies to reshuffle and recycle.
+ * with --store, seeds whose results are already in FILE aren't played again
+ * and new results are added to it. a new FILE gets room for
+ * --store-capacity results, twice the games by default, and keeps the
+ * turn cap it was created with; another --turn-cap is refused.
+ * with --deck, every deal of a reduced deck is played once instead, e.g.
+ * --deck=JQK --suits=4 for Jacks, Queens and Kings in 4 suits (4 is the
+ * default); games and seed are ignored. RANKS are written 23456789TJQKA.
+ * --table writes the outcome of every deal, one line each.
+ * with --corpus, game i is dealt deal seed + i of a deal corpus FILE instead
+ * of being shuffled; games defaults to the rest of the corpus.
+ * --make-corpus writes a corpus of games deals for each value of PROPERTY
+ * (aces in the first hand, wars under the rules, or none, the default),
+ * drawn from the seeds from seed on; --ranks stores 26 bytes a deal instead
+ * of 52.
+ */
+
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "sources/batch.hpp"
+#include "sources/deal_corpus.hpp"
+#include "sources/enumeration.hpp"
+#include "sources/trace.hpp"
+
+using namespace std;
+using namespace ariel;
+
+namespace {
+
+ostream &operator<<(ostream &out, const Fraction &fraction) {
+  return out << fraction.numerator << "/" << fraction.denominator << " (" << fraction.value() << ")";
+}
+
+int runEnumeration(const string &ranks, int suits, const string &tablePath, const EnumerationOptions &options) {
+  vector<int> parsed;
+  for (char symbol : ranks) {
+    const size_t rank = canonical::RANK_SYMBOLS.find(symbol);
+    if (rank == string_view::npos) {
+      cerr << "unknown rank " << symbol << ", use 23456789TJQKA" << endl;
+      return 1;
+    }
+    parsed.push_back(static_cast<int>(rank) + card::MIN_RANK);
+  }
+
+  Enumeration result;
+  try {
+    const ReducedDeck deck(parsed, suits);
+    result = enumerate(deck, options);
+    cout << "deck: " << ranks << " in " << suits << " suits, " << deck.cards() << " cards" << endl;
+    cout << "deals: " << result.deals << " orders of the ranks, each for " << result.multiplicity
+         << " orders of the cards" << endl;
+
+    cout << "P1 wins: " << result.probability(result.p1Wins) << ", P2 wins: " << result.probability(result.p2Wins)
+         << ", ties: " << result.probability(result.ties) << endl;
+    cout << "turns: " << result.turns << ", draws: " << result.draws << endl;
+
+    if (!tablePath.empty()) {
+      ofstream table(tablePath);
+      table << "index,deal,winner,turns,draws\n";
+      const array<const char *, 3> winners = {"tie", "p1", "p2"};
+      for (uint64_t index = 0; index < result.deals; ++index) {
+        const DealOutcome &outcome = result.table[index];
+        table << index << "," << canonical::rankString(deck.deal(index)) << "," << winners[outcome.winner] << ","
+              << unsigned{outcome.turns} << "," << unsigned{outcome.draws} << "\n";
+      }
+      if (!table) {
+        cerr << "can't write " << tablePath << endl;
+        return 1;
+      }
+      cout << "table written to " << tablePath << endl;
+    }
+  } catch (const exception &error) {
+    cerr << error.what() << endl;
+    return 1;
+  }
+  return 0;
+}
+
+int runMakeCorpus(const string &path, const CorpusOptions &options) {
+  try {
+    const uint64_t candidates = writeCorpus(path, options);
+    const DealCorpus corpus(path);
+    cout << "corpus: " << corpus.size() << " deals in " << path;
+    if (corpus.strata() != 0) {
+      cout << ", " << corpus.perStratum() << " for each of " << corpus.strata() << " " << propertyName(options.property)
+           << " strata";
+    }
+    cout << ", from " << candidates << " seeds" << endl;
+  } catch (const exception &error) {
+    cerr << error.what() << endl;
+    return 1;
+  }
+  return 0;
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+  BatchOptions options;
+  string storePath;
+  size_t storeCapacity = 0;
+  string deck;
+  int suits = card::SUITS;
+  string tablePath;
+  string corpusPath;
+  string makeCorpusPath;
+  CorpusOptions corpusOptions;
+  corpusOptions.property = CorpusProperty::None;
+  vector<string> args;
+  for (int i = 1; i < argc; ++i) {
+    const string arg = argv[i];
+    if (arg.rfind("--rules=", 0) == 0) {
+      const auto variant = parseVariant(arg.substr(8));
+      if (!variant) {
+        cerr << "unknown rules " << arg.substr(8) << endl;
+        return 1;
+      }
+      options.variant = *variant;
+    } else if (arg.rfind("--turn-cap=", 0) == 0) {
+      options.turnCap = static_cast<uint32_t>(stoul(arg.substr(11)));
+    } else if (arg.rfind("--store=", 0) == 0) {
+      storePath = arg.substr(8);
+    } else if (arg.rfind("--store-capacity=", 0) == 0) {
+      storeCapacity = stoull(arg.substr(17));
+    } else if (arg.rfind("--deck=", 0) == 0) {
+      deck = arg.substr(7);
+    } else if (arg.rfind("--suits=", 0) == 0) {
+      suits = stoi(arg.substr(8));
+    } else if (arg.rfind("--table=", 0) == 0) {
+      tablePath = arg.substr(8);
+    } else if (arg.rfind("--corpus=", 0) == 0) {
+      corpusPath = arg.substr(9);
+    } else if (arg.rfind("--make-corpus=", 0) == 0) {
+      makeCorpusPath = arg.substr(14);
+    } else if (arg.rfind("--stratify=", 0) == 0) {
+      const auto property = parseProperty(arg.substr(11));
+      if (!property) {
+        cerr << "unknown property " << arg.substr(11) << ", use none, aces or wars" << endl;
+        return 1;
+      }
+      corpusOptions.property = *property;
+    } else if (arg == "--ranks") {
+      corpusOptions.format = DealCorpus::Format::Ranks;
+    } else {
+      args.push_back(arg);
+    }
+  }
+  options.games = args.size() > 0 ? stoull(args[0]) : 10000;
+  options.threads = args.size() > 1 ? static_cast<unsigned>(stoul(args[1])) : max(1U, thread::hardware_concurrency());
+  options.seed = args.size() > 2 ? stoull(args[2]) : 0;
+
+  if (!deck.empty()) {
+    EnumerationOptions enumeration;
+    enumeration.variant = options.variant;
+    enumeration.threads = options.threads;
+    enumeration.table = !tablePath.empty();
+    return runEnumeration(deck, suits, tablePath, enumeration);
+  }
+
+  if (!makeCorpusPath.empty()) {
+    corpusOptions.perStratum = options.games;
+    corpusOptions.seed = options.seed;
+    corpusOptions.variant = options.variant;
+    return runMakeCorpus(makeCorpusPath, corpusOptions);
+  }
+
+  unique_ptr<DealCorpus> corpus;
+  if (!corpusPath.empty()) {
+    try {
+      corpus = make_unique<DealCorpus>(corpusPath);
+    } catch (const runtime_error &error) {
+      cerr << error.what() << endl;
+      return 1;
+    }
+    if (options.seed > corpus->size()) {
+      cerr << corpusPath << " holds " << corpus->size() << " deals" << endl;
+      return 1;
+    }
+    options.games = args.empty() ? corpus->size() - options.seed : min(options.games, corpus->size() - options.seed);
+    options.corpus = corpus.get();
+  }
+
+  unique_ptr<ResultStore> store;
+  if (!storePath.empty()) {
+    if (corpus) {
+      cerr << "--store keys games by seed, it can't be used with --corpus" << endl;
+      return 1;
+    }
+    try {
+      store = make_unique<ResultStore>(storePath, ResultStore::Mode::Write,
+                                       storeCapacity != 0 ? storeCapacity : 2 * options.games, options.turnCap);
+    } catch (const runtime_error &error) {
+      cerr << error.what() << endl;
+      return 1;
+    }
+    options.store = store.get();
+  }
+
+  trace::setThreadName("main");
+  BatchStats stats;
+  try {
+    stats = runBatch(options);
+  } catch (const exception &error) {
+    cerr << "batch failed: " << error.what() << endl;
+    return 1;
+  }
+
+  cout << "games: " << stats.games << endl;
+  cout << "P1 wins: " << stats.p1Wins << ", P2 wins: " << stats.p2Wins << ", ties: " << stats.ties << endl;
+  cout << "turns: " << stats.turns << ", draws: " << stats.draws << endl;
+  if (options.variant == Variant::Reshuffle || options.variant == Variant::Recycle) {
+    cout << "cycles: " << stats.cycles << ", capped at " << options.turnCap << " turns: " << stats.capped << endl;
+  }
+  if (store) {
+    cout << "from " << storePath << ": " << stats.stored << " games, now holding " << store->size() << " of "
+         << store->capacity() << " results" << endl;
+  }
+
+  if (args.size() > 3) {
+    if (!trace::enabled) {
+      cerr << "tracing is compiled out, rebuild with `make TRACE=1`" << endl;
+      return 1;
+    }
+    if (!trace::writeJson(args[3])) {
+      cerr << "can't write " << args[3] << endl;
+      return 1;
+    }
+    cout << "trace written to " << args[3] << " (" << trace::dropped() << " events dropped)" << endl;
+  }
+}
@@ -0,0 +1,543 @@
+/**
+ * Micro benchmarks for the game engine.
+ *
+ * usage: ./bench [name [games]]
+ * runs every benchmark when no name is given.
+ */
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <filesystem>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <numeric>
+#include <random>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+#include "sources/alloc_stats.hpp"
+#include "sources/canonical.hpp"
+#include "sources/deal_corpus.hpp"
+#include "sources/game.hpp"
+#include "sources/game_impl.hpp"
+#include "sources/game_pool.hpp"
+#include "sources/outcome_cache.hpp"
+#include "sources/player.hpp"
+
+using namespace std;
+using namespace ariel;
+
+// observers for benchObserver(): one whose hooks are all GameObserver's
+// empty ones, and one counting wars and splits. their games are compiled
+// out of line at the end of this file, as game.cpp does for Game, so all
+// three are timed through the same kind of call.
+struct QuietObserver : GameObserver {};
+
+struct WarCounter : GameObserver {
+  uint64_t wars = 0;
+  uint64_t splits = 0;
+
+  void onWarStart(unsigned, uint8_t, uint8_t) { ++wars; }
+  void onSplit(const GameBase::PlayedTurn &) { ++splits; }
+};
+
+extern template class ariel::BasicGame<ClassicRules, QuietObserver>;
+extern template class ariel::BasicGame<ClassicRules, WarCounter>;
+
+namespace {
+
+struct Benchmark {
+  string name;
+  uint64_t defaultGames;
+  function<void(uint64_t)> run;
+};
+
+// keeps the optimizer from dropping the games we time.
+volatile int sink = 0;
+
+void report(const string &label, uint64_t games, chrono::steady_clock::duration elapsed) {
+  const double nanos = static_cast<double>(chrono::duration_cast<chrono::nanoseconds>(elapsed).count());
+  cout << "  " << label << ": " << nanos / static_cast<double>(games) << " ns/game (" << games << " games, "
+       << nanos / 1e9 << " s)" << endl;
+}
+
+template <typename Body>
+void timeGames(const string &label, uint64_t games, Body body) {
+  const auto start = chrono::steady_clock::now();
+  for (uint64_t i = 0; i < games; ++i) {
+    body(i);
+  }
+  report(label, games, chrono::steady_clock::now() - start);
+}
+
+void benchPool(uint64_t games) {
+  Player p1("Alice");
+  Player p2("Bob");
+
+  timeGames("fresh Game", games, [&](uint64_t seed) {
+    Game game(p1, p2, seed);
+    game.playAll();
+    sink = sink + game.turns();
+  });
+
+  GamePool &pool = GamePool::local();
+  timeGames("pooled Game", games, [&](uint64_t seed) {
+    GamePool::Handle game = pool.acquire(p1, p2, seed);
+    game->playAll();
+    sink = sink + game->turns();
+  });
+}
+
+// Game binds to its players by reference, so constructing one can't copy a
+// player: the type system rules it out, and the allocation counters show that
+// no name is allocated. the log is sized once per game.
+void benchConstruct(uint64_t games) {
+  static_assert(!is_copy_constructible_v<Player> && !is_move_constructible_v<Player>,
+                "Game construction must not be able to copy players");
+
+  Player p1("A player with a name longer than the SSO buffer");
+  Player p2("Another player with a name longer than the SSO buffer");
+  { Game warmup(p1, p2, 0); }
+
+  alloc::reset();
+  alloc::setTracking(true);
+  timeGames("construct + destroy", games, [&](uint64_t seed) {
+    Game game(p1, p2, seed);
+    sink = sink + p1.stacksize();
+  });
+  alloc::setTracking(false);
+
+  for (auto component : {alloc::Component::Name, alloc::Component::GameLog}) {
+    cout << "  " << alloc::name(component) << " allocations: " << alloc::counters(component).allocations << endl;
+  }
+}
+
+// an interactive session as in Demo.cpp: a game dealt, 5 turns played and
+// the rest abandoned, with the deck shuffled up front or dealt lazily.
+void benchSession(uint64_t games) {
+  Player p1("Alice");
+  Player p2("Bob");
+  const int turns = 5;
+
+  timeGames("shuffled deal, 5 turns", games, [&](uint64_t seed) {
+    Game game(p1, p2, seed);
+    for (int turn = 0; turn < turns; ++turn) {
+      game.playTurn();
+    }
+    sink = sink + game.stackSize();
+  });
+  timeGames("lazy deal, 5 turns", games, [&](uint64_t seed) {
+    Game game(p1, p2, seed, LazyDeal{});
+    for (int turn = 0; turn < turns; ++turn) {
+      game.playTurn();
+    }
+    sink = sink + game.stackSize();
+  });
+  timeGames("lazy deal, whole game", games, [&](uint64_t seed) {
+    Game game(p1, p2, seed, LazyDeal{});
+    game.playAll();
+    sink = sink + game.turns();
+  });
+}
+
+// an online consumer of turns, here the cards each seat took: stepping
+// with playTurn() and reading lastPot(), or from turnStream(), to the end
+// or stopping after 5 turns.
+void benchStream(uint64_t games) {
+  Player p1("Alice");
+  Player p2("Bob");
+
+  timeGames("playTurn + lastPot", games, [&](uint64_t seed) {
+    Game game(p1, p2, seed, LazyDeal{});
+    while (!game.finished()) {
+      game.playTurn();
+      sink = sink + static_cast<int>(game.lastPot().size());
+    }
+  });
+  timeGames("turnStream", games, [&](uint64_t seed) {
+    Game game(p1, p2, seed, LazyDeal{});
+    for (const Game::PlayedTurn &turn : game.turnStream()) {
+      sink = sink + turn.potSize;
+    }
+  });
+  timeGames("turnStream, 5 turns", games, [&](uint64_t seed) {
+    Game game(p1, p2, seed, LazyDeal{});
+    for (const Game::PlayedTurn &turn : game.turnStream()) {
+      sink = sink + turn.potSize;
+      if (turn.number == 5) {
+        break;
+      }
+    }
+  });
+}
+
+// formatting turns as printLastTurn() and printLog() do, on finished games
+// kept from the start, so only the formatting is timed.
+void benchFormat(uint64_t turns) {
+  const size_t distinct = 256;
+  vector<unique_ptr<Player>> players;
+  vector<unique_ptr<Game>> games;
+  for (size_t i = 0; i < distinct; ++i) {
+    players.push_back(make_unique<Player>("Alice"));
+    players.push_back(make_unique<Player>("Bob"));
+    games.push_back(make_unique<Game>(*players[2 * i], *players[2 * i + 1], i));
+    games.back()->playTurn();
+  }
+
+  size_t chars = 0;
+  timeGames("lastTurn()", turns, [&](uint64_t i) { chars += games[i % distinct]->lastTurn().size(); });
+  sink = sink + static_cast<int>(chars & 1);
+}
+
+// counts L1 data cache read misses of this thread through perf_event_open.
+// valid() is false where the counter isn't available (not linux, no PMU, or
+// perf_event_paranoid too strict); `make cachegrind` is the fallback there.
+class L1Misses {
+  int fd_ = -1;
+
+public:
+  L1Misses() {
+#ifdef __linux__
+    perf_event_attr attr{};
+    attr.size = sizeof(attr);
+    attr.type = PERF_TYPE_HW_CACHE;
+    attr.config = PERF_COUNT_HW_CACHE_L1D | (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+                  (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+    attr.disabled = 1;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    fd_ = static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));
+#endif
+  }
+  ~L1Misses() {
+#ifdef __linux__
+    if (fd_ >= 0) {
+      close(fd_);
+    }
+#endif
+  }
+  L1Misses(const L1Misses &) = delete;
+  L1Misses &operator=(const L1Misses &) = delete;
+
+  bool valid() const { return fd_ >= 0; }
+
+  void start() {
+#ifdef __linux__
+    if (valid()) {
+      ioctl(fd_, PERF_EVENT_IOC_RESET, 0);
+      ioctl(fd_, PERF_EVENT_IOC_ENABLE, 0);
+    }
+#endif
+  }
+
+  uint64_t stop() {
+    uint64_t count = 0;
+#ifdef __linux__
+    if (valid()) {
+      ioctl(fd_, PERF_EVENT_IOC_DISABLE, 0);
+      if (read(fd_, &count, sizeof(count)) != static_cast<ssize_t>(sizeof(count))) {
+        count = 0;
+      }
+    }
+#endif
+    return count;
+  }
+};
+
+// the cost of playTurn() per turn, in time and, where the counter can be
+// read, L1d read misses. no miss figures have been recorded for the hot
+// block layout yet, so compare against an older build before reading
+// anything into them. the deal is outside the counted region.
+void benchTurns(uint64_t games) {
+  Player p1("Alice");
+  Player p2("Bob");
+  L1Misses misses;
+  uint64_t turns = 0;
+  uint64_t missed = 0;
+  chrono::steady_clock::duration elapsed{};
+
+  for (uint64_t seed = 0; seed < games; ++seed) {
+    Game game(p1, p2, seed);
+    misses.start();
+    const auto start = chrono::steady_clock::now();
+    while (!game.finished()) {
+      game.playTurn();
+    }
+    elapsed += chrono::steady_clock::now() - start;
+    missed += misses.stop();
+    turns += static_cast<uint64_t>(game.turns());
+  }
+
+  const double nanos = static_cast<double>(chrono::duration_cast<chrono::nanoseconds>(elapsed).count());
+  cout << "  playTurn: " << nanos / static_cast<double>(turns) << " ns/turn (" << turns << " turns)" << endl;
+  if (misses.valid()) {
+    cout << "  L1d read misses: " << static_cast<double>(missed) / static_cast<double>(turns) << " per turn" << endl;
+  } else {
+    cout << "  L1d miss counter unavailable, try `make cachegrind`" << endl;
+  }
+}
+
+// fastForward() against a playTurn() loop on the same deals; only the play
+// is timed, the deal is the same for both.
+void benchFastForward(uint64_t games) {
+  Player p1("Alice");
+  Player p2("Bob");
+  chrono::steady_clock::duration logged{};
+  chrono::steady_clock::duration forwarded{};
+
+  for (uint64_t seed = 0; seed < games; ++seed) {
+    {
+      Game game(p1, p2, seed);
+      const auto start = chrono::steady_clock::now();
+      while (!game.finished()) {
+        game.playTurn();
+      }
+      logged += chrono::steady_clock::now() - start;
+      sink = sink + game.turns();
+    }
+    {
+      Game game(p1, p2, seed);
+      const auto start = chrono::steady_clock::now();
+      game.fastForward();
+      forwarded += chrono::steady_clock::now() - start;
+      sink = sink + game.turns();
+    }
+  }
+  report("playTurn loop", games, logged);
+  report("fastForward", games, forwarded);
+}
+
+template <typename ObservedGame>
+void timeForward(const string &label, uint64_t games) {
+  Player p1("Alice");
+  Player p2("Bob");
+  chrono::steady_clock::duration elapsed{};
+  for (uint64_t seed = 0; seed < games; ++seed) {
+    ObservedGame game(p1, p2, seed);
+    const auto start = chrono::steady_clock::now();
+    game.fastForward();
+    elapsed += chrono::steady_clock::now() - start;
+    sink = sink + game.turns();
+  }
+  report(label, games, elapsed);
+}
+
+// fastForward() without an observer, with one that hides no hook, which
+// compiles to the same code, and with one that counts wars and splits; the
+// deal isn't timed.
+void benchObserver(uint64_t games) {
+  timeForward<Game>("no observer", games);
+  timeForward<BasicGame<ClassicRules, QuietObserver>>("empty hooks", games);
+  timeForward<BasicGame<ClassicRules, WarCounter>>("counting wars", games);
+}
+
+// times playAll() on a fixed list of rank string deals, per turn; the deal
+// isn't timed.
+void timeDeals(const string &label, const vector<string> &deals, Player &p1, Player &p2) {
+  uint64_t turns = 0;
+  uint64_t draws = 0;
+  chrono::steady_clock::duration elapsed{};
+  for (const string &ranks : deals) {
+    Game game(p1, p2, ranks);
+    const auto start = chrono::steady_clock::now();
+    game.playAll();
+    elapsed += chrono::steady_clock::now() - start;
+    turns += static_cast<uint64_t>(game.turns());
+    draws += static_cast<uint64_t>(game.draws());
+  }
+  const double nanos = static_cast<double>(chrono::duration_cast<chrono::nanoseconds>(elapsed).count());
+  cout << "  " << label << ": " << nanos / static_cast<double>(turns) << " ns/turn, "
+       << static_cast<double>(draws) / static_cast<double>(turns) << " draws/turn (" << deals.size() << " games)"
+       << endl;
+}
+
+// deals built for chained wars: both hands hold the same ranks in the same
+// order, which wars on every turn to the end of the deck, except that two
+// cards of the second hand trade places, so a chain breaks wherever they
+// come face up and the next turn starts a new one. the same number of
+// random deals is timed for comparison.
+void benchWars(uint64_t games) {
+  Player p1("Alice");
+  Player p2("Bob");
+  string hand;
+  for (const char rank : canonical::RANK_SYMBOLS) {
+    hand.append(card::SUITS / 2, rank);
+  }
+
+  vector<string> chained;
+  vector<string> random;
+  chained.reserve(games);
+  random.reserve(games);
+  for (uint64_t i = 0; i < games; ++i) {
+    mt19937_64 rng(i);
+    shuffle(hand.begin(), hand.end(), rng);
+    string second = hand;
+    swap(second[rng() % second.size()], second[rng() % second.size()]);
+    chained.push_back(hand + second);
+
+    string deck = hand + hand;
+    shuffle(deck.begin(), deck.end(), rng);
+    random.push_back(deck);
+  }
+
+  timeDeals("random deals", random, p1, p2);
+  timeDeals("chained wars", chained, p1, p2);
+}
+
+// playAll() through an OutcomeCache: a first pass over the seeds misses and
+// fills the cache, a second pass over the same seeds hits. the cache has room
+// for twice the seeds, since replaying a scan through a full cache makes
+// every miss evict an entry the scan has yet to reach.
+void benchCache(uint64_t games) {
+  Player p1("Alice");
+  Player p2("Bob");
+  OutcomeCache cache(static_cast<size_t>(2 * games));
+
+  for (const char *label : {"misses", "hits"}) {
+    timeGames(label, games, [&](uint64_t seed) {
+      Game game(p1, p2, seed);
+      game.playAll(cache);
+      sink = sink + game.turns();
+    });
+  }
+  const OutcomeCache::Stats stats = cache.stats();
+  cout << "  " << stats.hits << " hits, " << stats.misses << " misses, " << stats.evictions << " evictions, hit rate "
+       << stats.hitRate() << endl;
+}
+
+// constructing a game from a seed, which shuffles, against constructing it
+// from the same deal given up front, as a replayed corpus would.
+void benchDeal(uint64_t games) {
+  Player p1("Alice");
+  Player p2("Bob");
+  const uint64_t distinct = 4096;
+  vector<array<uint8_t, card::DECK_SIZE>> decks(distinct);
+  for (uint64_t seed = 0; seed < distinct; ++seed) {
+    iota(decks[seed].begin(), decks[seed].end(), uint8_t{0});
+    mt19937_64 rng(seed);
+    shuffle(decks[seed].begin(), decks[seed].end(), rng);
+  }
+
+  timeGames("seeded deal", games, [&](uint64_t i) {
+    Game game(p1, p2, i % distinct);
+    sink = sink + game.stackSize();
+  });
+  timeGames("given deal", games, [&](uint64_t i) {
+    Game game(p1, p2, decks[i % distinct]);
+    sink = sink + game.stackSize();
+  });
+}
+
+// whole games streamed from a deal corpus in each format against the same
+// games dealt from their seeds. the corpus is written to a temporary file
+// first and replayed from the start when the games outnumber its deals.
+void benchCorpus(uint64_t games) {
+  Player p1("Alice");
+  Player p2("Bob");
+  const uint64_t distinct = 1 << 16;
+  const string path = (filesystem::temp_directory_path() / "bench-corpus.bin").string();
+
+  timeGames("seeded", games, [&](uint64_t i) {
+    Game game(p1, p2, i % distinct);
+    game.fastForward();
+    sink = sink + game.turns();
+  });
+  for (DealCorpus::Format format : {DealCorpus::Format::Cards, DealCorpus::Format::Ranks}) {
+    CorpusOptions options;
+    options.format = format;
+    options.property = CorpusProperty::None;
+    options.perStratum = distinct;
+    writeCorpus(path, options);
+    const DealCorpus corpus(path);
+    array<uint8_t, card::DECK_SIZE> scratch{};
+    timeGames(format == DealCorpus::Format::Cards ? "corpus, 52 byte deals" : "corpus, 26 byte deals", games,
+              [&](uint64_t i) {
+                Game game(p1, p2, corpus.deal(i % distinct, scratch.data()));
+                game.fastForward();
+                sink = sink + game.turns();
+              });
+  }
+  filesystem::remove(path);
+}
+
+// canonical::canonicalize() and RankKey::hash() on shuffled decks, dealt up
+// front; the results are summed so none of the work can be dropped.
+void benchCanonical(uint64_t deals) {
+  const size_t distinct = 4096;
+  vector<array<uint8_t, card::DECK_SIZE>> decks(distinct);
+  mt19937_64 rng(1);
+  for (auto &deck : decks) {
+    iota(deck.begin(), deck.end(), uint8_t{0});
+    shuffle(deck.begin(), deck.end(), rng);
+  }
+
+  // a full deck, then half of one, which also counts the copies of each rank.
+  for (size_t cards : {size_t{card::DECK_SIZE}, size_t{card::DECK_SIZE / 2}}) {
+    uint64_t sum = 0;
+    const auto start = chrono::steady_clock::now();
+    for (uint64_t i = 0; i < deals; ++i) {
+      const auto &deck = decks[i % distinct];
+      const canonical::Canonical canonical = canonical::canonicalize(deck.data(), cards);
+      sum += canonical.key.hash() + canonical.multiplicity;
+    }
+    const auto elapsed = chrono::steady_clock::now() - start;
+    sink = sink + static_cast<int>(sum & 1);
+
+    const double nanos = static_cast<double>(chrono::duration_cast<chrono::nanoseconds>(elapsed).count());
+    cout << "  " << cards << " cards: " << nanos / static_cast<double>(deals) << " ns/deal, "
+         << static_cast<double>(deals) / nanos * 1e3 << " M deals/s (" << deals << " deals)" << endl;
+  }
+}
+
+const vector<Benchmark> &benchmarks() {
+  static const vector<Benchmark> all = {
+      {"pool", 1000000, benchPool},
+      {"construct", 1000000, benchConstruct},
+      {"session", 1000000, benchSession},
+      {"stream", 200000, benchStream},
+      {"turns", 200000, benchTurns},
+      {"wars", 100000, benchWars},
+      {"fastforward", 1000000, benchFastForward},
+      {"observer", 1000000, benchObserver},
+      {"cache", 200000, benchCache},
+      {"canonical", 20000000, benchCanonical},
+      {"deal", 1000000, benchDeal},
+      {"format", 1000000, benchFormat},
+      {"corpus", 1000000, benchCorpus},
+  };
+  return all;
+}
+
+} // namespace
+
+template class ariel::BasicGame<ClassicRules, QuietObserver>;
+template class ariel::BasicGame<ClassicRules, WarCounter>;
+
+int main(int argc, char **argv) {
+  const string only = argc > 1 ? argv[1] : "";
+  bool found = false;
+  for (const Benchmark &bench : benchmarks()) {
+    if (!only.empty() && bench.name != only) {
+      continue;
+    }
+    found = true;
+    cout << bench.name << ":" << endl;
+    bench.run(argc > 2 ? stoull(argv[2]) : bench.defaultGames);
+  }
+  if (!found) {
+    cerr << "unknown benchmark " << only << endl;
+    return 1;
+  }
+}
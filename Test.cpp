@@ -1,8 +1,36 @@
 #include "doctest.h"
 
+#include "sources/canonical.hpp"
 #include "sources/card.hpp"
+#include "sources/deal_corpus.hpp"
+#include "sources/enumeration.hpp"
 #include "sources/game.hpp"
+#include "sources/game_impl.hpp"
 #include "sources/player.hpp"
+#include "sources/alloc_stats.hpp"
+#include "sources/batch.hpp"
+#include "sources/game_pool.hpp"
+#include "sources/names.hpp"
+#include "sources/turn.hpp"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <memory>
+#include <memory_resource>
+#include <numeric>
+#include <random>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
 
 using namespace ariel;
 
@@ -337,4 +365,1774 @@ TEST_CASE("Exceptions Test") {
         Player p3("Bob");
         CHECK_THROWS(Game(p1,p3));
     }
-}
\ No newline at end of file
+}
+
+TEST_CASE("Allocation Tracking") {
+    alloc::setTracking(true);
+    alloc::reset();
+    {
+        const auto names_interned = names::size();
+        Player p1("A player with a name nobody used before");
+        Player p2("Bob");
+        CHECK_EQ(names::size(), names_interned + 1);
+
+        // names are interned once and shared by every player with the same name.
+        const auto names_allocated = alloc::counters(alloc::Component::Name).allocations;
+        Player p3("A player with a name nobody used before");
+        CHECK_EQ(alloc::counters(alloc::Component::Name).allocations, names_allocated);
+        CHECK_EQ(p1.nameId(), p3.nameId());
+        CHECK_EQ(p3.name(), "A player with a name nobody used before");
+
+        // the log is sized for a whole game when it is dealt, playing
+        // allocates nothing.
+        Game game(p1,p2);
+        const auto log_allocations = alloc::counters(alloc::Component::GameLog).allocations;
+        CHECK_GT(log_allocations, 0);
+        const auto stats_allocations = alloc::counters(alloc::Component::Stats).allocations;
+
+        game.playAll();
+        CHECK_EQ(alloc::counters(alloc::Component::GameLog).allocations, log_allocations);
+        CHECK_EQ(alloc::counters(alloc::Component::Stats).allocations, stats_allocations);
+        CHECK_NOTHROW(game.printStats());
+    }
+    for (auto component : {alloc::Component::GameLog, alloc::Component::Stats}) {
+        CHECK_EQ(alloc::counters(component).liveBytes(), 0);
+    }
+
+    alloc::setTracking(false);
+    alloc::reset();
+    {
+        Player p1("Alice");
+        Player p2("Bob");
+        Game game(p1,p2);
+        game.playAll();
+    }
+    CHECK_EQ(alloc::counters(alloc::Component::GameLog).allocations, 0);
+
+    // a free is counted exactly when its allocation was, however tracking
+    // is switched in between.
+    {
+        alloc::Vector<int, alloc::Component::Stats> untracked(100);
+        alloc::setTracking(true);
+        alloc::Vector<int, alloc::Component::Stats> tracked(50);
+        alloc::Vector<int, alloc::Component::Stats>().swap(untracked);
+        CHECK_EQ(alloc::counters(alloc::Component::Stats).deallocations, 0);
+        CHECK_EQ(alloc::counters(alloc::Component::Stats).liveBytes(), 50 * sizeof(int));
+        alloc::setTracking(false);
+    }
+    CHECK_EQ(alloc::counters(alloc::Component::Stats).deallocations, 1);
+    CHECK_EQ(alloc::counters(alloc::Component::Stats).liveBytes(), 0);
+
+    // nor is the free of a block counted before a reset.
+    {
+        alloc::setTracking(true);
+        alloc::Vector<int, alloc::Component::Stats> before(10);
+        alloc::reset();
+    }
+    alloc::setTracking(false);
+    CHECK_EQ(alloc::counters(alloc::Component::Stats).deallocations, 0);
+}
+
+TEST_CASE("Memory Resource") {
+    // everything the game allocates must come from the arena:
+    // the upstream null resource throws on any allocation that escapes it.
+    std::vector<std::byte> buffer(std::size_t{1} << 20);
+    std::pmr::monotonic_buffer_resource arena(buffer.data(), buffer.size(), std::pmr::null_memory_resource());
+    std::pmr::memory_resource *previous = std::pmr::set_default_resource(std::pmr::null_memory_resource());
+
+    SUBCASE("the game allocates from the arena") {
+        Player p1("A player with a long name");
+        Player p2("Another player with a long name");
+        CHECK_NOTHROW({
+            Game game(p1, p2, 42, &arena);
+            game.playAll();
+        });
+    }
+
+    SUBCASE("default resource is used otherwise") {
+        Player p1("Alice");
+        Player p2("Bob");
+        CHECK_THROWS_AS(Game(p1, p2, 42), std::bad_alloc);
+        // a game that failed to deal doesn't keep the players.
+        CHECK_FALSE(p1.inGame());
+        CHECK_FALSE(p2.inGame());
+    }
+
+    SUBCASE("a batch whose workers throw fails cleanly") {
+        // without arenas, every worker's games hit the null resource.
+        BatchOptions options;
+        options.games = 30;
+        options.threads = 3;
+        options.arenaBytes = 0;
+        CHECK_THROWS_AS(runBatch(options), std::bad_alloc);
+    }
+
+    std::pmr::set_default_resource(previous);
+}
+
+TEST_CASE("Game Pool") {
+    Player p1("Alice");
+    Player p2("Bob");
+    GamePool pool;
+
+    {
+        GamePool::Handle game = pool.acquire(p1, p2, 1);
+        CHECK_EQ(p1.stacksize(), 26);
+        Player p3("Carol");
+        CHECK_THROWS(pool.acquire(p1, p3, 2));
+        game->playTurn();
+        CHECK_LT(p1.stacksize(), 26);
+    }
+    // an unfinished game releases its players when it's reclaimed.
+    CHECK_EQ(pool.idle(), 1);
+
+    GamePool::Handle game = pool.acquire(p1, p2, 1);
+    CHECK_EQ(pool.idle(), 0);
+    CHECK_EQ(p1.stacksize(), 26);
+    CHECK_EQ(p1.cardesTaken(), 0);
+    CHECK_EQ(game->turns(), 0);
+    game->playAll();
+    CHECK(game->finished());
+    CHECK_EQ(p1.stacksize() + p2.stacksize(), 0);
+    // half of every pot is won from the other player, all of a split pot
+    // is taken back.
+    CHECK_GE(p1.cardesTaken() + p2.cardesTaken(), 26);
+}
+
+TEST_CASE("Concurrent Games") {
+    // threads race to build games out of a small set of players; a player
+    // must never be in two live games at once.
+    const std::size_t players_count = 6;
+    const int threads_count = 4;
+    const int attempts = 2000;
+
+    std::vector<std::unique_ptr<Player>> players;
+    for (std::size_t i = 0; i < players_count; ++i) {
+        players.push_back(std::make_unique<Player>("Player " + std::to_string(i)));
+    }
+    std::array<std::atomic<int>, players_count> live{};
+    std::atomic<int> overlaps{0};
+    std::atomic<int> played{0};
+
+    std::vector<std::thread> threads;
+    for (int t = 0; t < threads_count; ++t) {
+        threads.emplace_back([&, t]() {
+            for (int i = 0; i < attempts; ++i) {
+                const auto first = static_cast<std::size_t>(t + i) % players_count;
+                const auto second = static_cast<std::size_t>(t * 7 + i * 5 + 1) % players_count;
+                try {
+                    Game game(*players[first], *players[second], static_cast<std::uint64_t>(i));
+                    for (std::size_t index : {first, second}) {
+                        if (live[index].fetch_add(1) != 0) {
+                            ++overlaps;
+                        }
+                    }
+                    game.playTurn();
+                    live[first].fetch_sub(1);
+                    live[second].fetch_sub(1);
+                    ++played;
+                } catch (const std::exception &) {
+                    // the player was busy or played himself, try another pair.
+                }
+            }
+        });
+    }
+    for (std::thread &thread : threads) {
+        thread.join();
+    }
+
+    CHECK_EQ(overlaps.load(), 0);
+    CHECK_GT(played.load(), 0);
+    for (const auto &player : players) {
+        CHECK_FALSE(player->inGame());
+    }
+}
+
+TEST_CASE("Interned Names") {
+    const int threads_count = 4;
+    const int names_count = 500;
+    std::vector<std::vector<names::Id>> ids(threads_count);
+
+    std::vector<std::thread> threads;
+    for (int t = 0; t < threads_count; ++t) {
+        threads.emplace_back([&ids, t]() {
+            for (int i = 0; i < names_count; ++i) {
+                ids[static_cast<std::size_t>(t)].push_back(names::intern("interned " + std::to_string(i)));
+            }
+        });
+    }
+    for (std::thread &thread : threads) {
+        thread.join();
+    }
+
+    for (int t = 1; t < threads_count; ++t) {
+        CHECK(ids[static_cast<std::size_t>(t)] == ids[0]);
+    }
+    CHECK_EQ(names::lookup(ids[0][42]), "interned 42");
+    CHECK_EQ(names::intern("interned 42"), ids[0][42]);
+}
+
+TEST_CASE("War Pot") {
+    Player p1("Alice");
+    Player p2("Bob");
+    for (std::uint64_t seed = 0; seed < 2000; ++seed) {
+        Game game(p1, p2, seed);
+        CHECK(game.lastPot().empty());
+
+        std::array<int, card::DECK_SIZE> seen{};
+        while (!game.finished()) {
+            const int stack = game.stackSize();
+            const int first = game.cardsTaken(0);
+            const int second = game.cardsTaken(1);
+            game.playTurn();
+
+            const std::vector<card> pot = game.lastPot();
+            const int size = static_cast<int>(pot.size());
+            CHECK_EQ(size, 2 * (stack - game.stackSize()));
+            // the taker wins the other player's half of the pot, or on a
+            // split each player takes back their own half
+            const int firstGot = game.cardsTaken(0) - first;
+            const int secondGot = game.cardsTaken(1) - second;
+            CHECK((firstGot == 0 || secondGot == 0 || firstGot == secondGot));
+            CHECK_EQ(2 * std::max(firstGot, secondGot), size);
+            for (const card &played : pot) {
+                ++seen[played.packed()];
+            }
+        }
+        // every card goes through exactly one pot
+        CHECK(std::all_of(seen.begin(), seen.end(), [](int count) { return count == 1; }));
+
+        int turns = 0;
+        for (int count : game.warDepths()) {
+            turns += count;
+        }
+        CHECK_EQ(turns, game.turns());
+    }
+}
+
+namespace {
+    // the turn rules played card by card, as written in the README.
+    struct ReferenceTurn {
+        std::vector<std::uint8_t> pot;
+        std::vector<std::uint8_t> faceUp;
+        unsigned drawn = 0;
+        unsigned wars = 0;
+        int compare = 0;
+        bool split = false;
+    };
+
+    template <typename Rules>
+    ReferenceTurn referenceTurn(const std::vector<std::uint8_t> &first, const std::vector<std::uint8_t> &second) {
+        ReferenceTurn turn;
+        const auto hand = static_cast<unsigned>(first.size());
+        while (true) {
+            const card mine = card::fromPacked(first[turn.drawn]);
+            const card theirs = card::fromPacked(second[turn.drawn]);
+            turn.pot.push_back(mine.packed());
+            turn.pot.push_back(theirs.packed());
+            turn.faceUp.push_back(mine.packed());
+            turn.faceUp.push_back(theirs.packed());
+            ++turn.drawn;
+            turn.compare = Rules::TWO_BEATS_ACE ? mine.compare(theirs) : mine.rank() - theirs.rank();
+            if (turn.compare != 0) {
+                return turn;
+            }
+            ++turn.wars;
+            if (hand - turn.drawn < Rules::FACE_DOWN + 1) {
+                for (unsigned i = turn.drawn; i < hand; ++i) {
+                    turn.pot.push_back(first[i]);
+                }
+                for (unsigned i = turn.drawn; i < hand; ++i) {
+                    turn.pot.push_back(second[i]);
+                }
+                turn.drawn = hand;
+                turn.split = true;
+                return turn;
+            }
+            for (unsigned i = 0; i < Rules::FACE_DOWN; ++i) {
+                turn.pot.push_back(first[turn.drawn + i]);
+            }
+            for (unsigned i = 0; i < Rules::FACE_DOWN; ++i) {
+                turn.pot.push_back(second[turn.drawn + i]);
+            }
+            turn.drawn += Rules::FACE_DOWN;
+        }
+    }
+
+    // every hand of up to 5 cards per player over three ranks, which covers
+    // ties, plain wins and a 2 against an Ace at every position, through
+    // turn::play() and the reference.
+    template <typename Rules>
+    void checkEveryHand() {
+        const unsigned max_hand = 5;
+        const std::array<int, 3> ranks = {2, 9, 14};
+        for (unsigned hand = 1; hand <= max_hand; ++hand) {
+            unsigned combinations = 1;
+            for (unsigned i = 0; i < 2 * hand; ++i) {
+                combinations *= ranks.size();
+            }
+            for (unsigned code = 0; code < combinations; ++code) {
+                std::vector<std::uint8_t> first;
+                std::vector<std::uint8_t> second;
+                unsigned digits = code;
+                for (unsigned i = 0; i < 2 * hand; ++i) {
+                    const card drawn(ranks[digits % ranks.size()], i < hand ? Suit::Hearts : Suit::Spades);
+                    (i < hand ? first : second).push_back(drawn.packed());
+                    digits /= ranks.size();
+                }
+
+                const ReferenceTurn expected = referenceTurn<Rules>(first, second);
+                std::array<std::uint8_t, 2 * (max_hand + Rules::FACE_DOWN)> pot{};
+                std::vector<std::uint8_t> faceUp;
+                const turn::Result played = turn::play<Rules>(first.data(), second.data(), hand, 0, pot.data(),
+                                                              [&](std::uint8_t mine, std::uint8_t theirs) {
+                                                                  faceUp.push_back(mine);
+                                                                  faceUp.push_back(theirs);
+                                                              });
+
+                REQUIRE_EQ(played.drawn, expected.drawn);
+                REQUIRE_EQ(played.split, expected.split);
+                REQUIRE_EQ(played.wars, expected.wars);
+                REQUIRE_EQ(played.compare > 0, expected.compare > 0);
+                REQUIRE_EQ(played.compare < 0, expected.compare < 0);
+                REQUIRE(std::equal(expected.pot.begin(), expected.pot.end(), pot.begin(), pot.begin() + played.potSize));
+                REQUIRE(faceUp == expected.faceUp);
+            }
+        }
+    }
+
+    struct ReferenceRecycle {
+        int turns = 0;
+        int winner = -1;   // seat holding every card, -1 on a cycle
+        int cycle = 0;     // turns between the first repeated position and its earlier copy
+    };
+
+    // RecycleRules with a queue per player: every position is kept, so the
+    // first repeat is found by lookup instead of Brent's algorithm.
+    ReferenceRecycle referenceRecycle(std::uint64_t seed) {
+        std::array<std::uint8_t, card::DECK_SIZE> deck;
+        std::iota(deck.begin(), deck.end(), std::uint8_t{0});
+        std::mt19937_64 rng(seed);
+        std::shuffle(deck.begin(), deck.end(), rng);
+        const auto hand = static_cast<std::ptrdiff_t>(card::DECK_SIZE / 2);
+        std::array<std::deque<std::uint8_t>, 2> cards = {std::deque<std::uint8_t>(deck.begin(), deck.begin() + hand),
+                                                         std::deque<std::uint8_t>(deck.begin() + hand, deck.end())};
+        std::map<std::array<std::deque<std::uint8_t>, 2>, int> seen{{cards, 0}};
+
+        ReferenceRecycle result;
+        while (true) {
+            std::vector<std::uint8_t> pot;
+            std::array<std::vector<std::uint8_t>, 2> own;
+            const auto put = [&](std::size_t seat, std::size_t count) {
+                for (std::size_t i = 0; i < count; ++i) {
+                    pot.push_back(cards[seat].front());
+                    own[seat].push_back(cards[seat].front());
+                    cards[seat].pop_front();
+                }
+            };
+            int winner = 0;
+            bool split = false;
+            while (true) {
+                put(0, 1);
+                put(1, 1);
+                const int compare = card::fromPacked(pot[pot.size() - 2]).compare(card::fromPacked(pot.back()));
+                if (compare != 0) {
+                    winner = compare > 0 ? 0 : 1;
+                    break;
+                }
+                const bool firstShort = cards[0].size() < 2;
+                const bool secondShort = cards[1].size() < 2;
+                if (firstShort || secondShort) {
+                    put(0, cards[0].size());
+                    put(1, cards[1].size());
+                    split = firstShort && secondShort;
+                    winner = firstShort ? 1 : 0;
+                    break;
+                }
+                put(0, 1);
+                put(1, 1);
+            }
+            if (split) {
+                cards[0].insert(cards[0].end(), own[0].begin(), own[0].end());
+                cards[1].insert(cards[1].end(), own[1].begin(), own[1].end());
+            } else {
+                cards[static_cast<std::size_t>(winner)].insert(cards[static_cast<std::size_t>(winner)].end(),
+                                                               pot.begin(), pot.end());
+            }
+            ++result.turns;
+
+            if (cards[0].empty() || cards[1].empty()) {
+                result.winner = cards[0].empty() ? 1 : 0;
+                return result;
+            }
+            const auto [at, inserted] = seen.emplace(cards, result.turns);
+            if (!inserted) {
+                result.cycle = result.turns - at->second;
+                return result;
+            }
+        }
+    }
+} // namespace
+
+TEST_CASE("End Of Deck Split") {
+    checkEveryHand<ClassicRules>();
+}
+
+TEST_CASE("Fast Forward") {
+    Player p1("Alice");
+    Player p2("Bob");
+    for (std::uint64_t seed = 0; seed < 1000; ++seed) {
+        Game logged(p1, p2, seed);
+        CHECK(logged.lastTurn().empty());
+        logged.playAll();
+        const std::string last = logged.lastTurn();
+        const std::vector<card> pot = logged.lastPot();
+
+        Game forwarded(p1, p2, seed);
+        forwarded.fastForward();
+        CHECK(forwarded.finished());
+        CHECK_EQ(forwarded.turns(), logged.turns());
+        CHECK_EQ(forwarded.draws(), logged.draws());
+        CHECK_EQ(forwarded.cardsTaken(0), logged.cardsTaken(0));
+        CHECK_EQ(forwarded.cardsTaken(1), logged.cardsTaken(1));
+        CHECK(forwarded.warDepths() == logged.warDepths());
+        CHECK_EQ(p1.cardesTaken(), logged.cardsTaken(0));
+        // the last turn is rebuilt from the pot
+        CHECK_EQ(forwarded.lastTurn(), last);
+        CHECK(forwarded.lastPot().size() == pot.size());
+    }
+
+    Game game(p1, p2, 7);
+    game.playTurn();
+    const std::string first = game.lastTurn();
+    CHECK_FALSE(first.empty());
+    game.fastForward();
+    CHECK(game.finished());
+    CHECK_NOTHROW(game.printLog());
+}
+
+TEST_CASE("Rule Variants") {
+    const std::uint8_t two = card(2, Suit::Hearts).packed();
+    const std::uint8_t ace = card(14, Suit::Spades).packed();
+    CHECK(turn::compare<ClassicRules>(two, ace) > 0);
+    CHECK(turn::compare<AceHighRules>(two, ace) < 0);
+
+    SUBCASE("every small hand") {
+        checkEveryHand<AceHighRules>();
+        checkEveryHand<FaceDownRules<2>>();
+        checkEveryHand<FaceDownRules<3>>();
+    }
+
+    SUBCASE("whole games") {
+        Player p1("Alice");
+        Player p2("Bob");
+        for (std::uint64_t seed = 0; seed < 500; ++seed) {
+            AceHighGame aceHigh(p1, p2, seed);
+            aceHigh.playAll();
+            CHECK_EQ(aceHigh.stackSize(), 0);
+            CHECK_GE(aceHigh.cardsTaken(0) + aceHigh.cardsTaken(1), card::DECK_SIZE / 2);
+
+            BasicGame<FaceDownRules<3>> threeDown(p1, p2, seed);
+            threeDown.playAll();
+            CHECK_EQ(threeDown.stackSize(), 0);
+            CHECK_GE(threeDown.cardsTaken(0) + threeDown.cardsTaken(1), card::DECK_SIZE / 2);
+            // a war takes four cards from each hand instead of two
+            CHECK(threeDown.warDepths().size() == 8);
+        }
+    }
+
+    SUBCASE("reshuffling") {
+        Player p1("Alice");
+        Player p2("Bob");
+        for (std::uint64_t seed = 0; seed < 200; ++seed) {
+            ReshuffleGame game(p1, p2, seed);
+            int turns = 0;
+            while (!game.finished()) {
+                game.playTurn();
+                ++turns;
+                REQUIRE_EQ(game.stackSize(0) + game.stackSize(1), card::DECK_SIZE);
+                REQUIRE_EQ(p1.stacksize(), game.stackSize(0));
+            }
+            CHECK_EQ(game.turns(), turns);
+            // someone holds every card; the turn count isn't capped at 26
+            const Player *winner = game.winner();
+            REQUIRE(winner != nullptr);
+            CHECK_EQ(winner->stacksize(), card::DECK_SIZE);
+
+            ReshuffleGame forwarded(p1, p2, seed);
+            forwarded.fastForward();
+            CHECK_EQ(forwarded.turns(), game.turns());
+            CHECK_EQ(forwarded.winner(), winner);
+            CHECK_EQ(forwarded.lastTurn(), game.lastTurn());
+        }
+    }
+
+    SUBCASE("cycles") {
+        Player p1("Alice");
+        Player p2("Bob");
+        int cycles = 0;
+        for (std::uint64_t seed = 0; seed < 100; ++seed) {
+            const ReferenceRecycle expected = referenceRecycle(seed);
+            RecycleGame game(p1, p2, seed);
+            game.fastForward();
+            if (expected.winner >= 0) {
+                REQUIRE(game.ending() == GameBase::Ending::Won);
+                CHECK_EQ(game.turns(), expected.turns);
+                CHECK_EQ(game.winner(), expected.winner == 0 ? &p1 : &p2);
+                continue;
+            }
+            ++cycles;
+            REQUIRE(game.ending() == GameBase::Ending::Cycle);
+            CHECK(game.winner() == nullptr);
+            CHECK_EQ(game.cycleLength(), expected.cycle);
+            // Brent's algorithm saves the position at turns 2^k - 1, so it stops
+            // within 2 * (first repeat) + cycle turns.
+            CHECK(game.turns() >= expected.turns);
+            CHECK(game.turns() <= 2 * expected.turns + expected.cycle);
+        }
+        CHECK(cycles > 0);
+    }
+
+    SUBCASE("turn cap") {
+        Player p1("Alice");
+        Player p2("Bob");
+        ReshuffleGame game(p1, p2, 1);
+        game.setTurnCap(10);
+        game.playAll();
+        CHECK(game.ending() == GameBase::Ending::Capped);
+        CHECK_EQ(game.turns(), 10);
+        CHECK(game.winner() == nullptr);
+        CHECK_EQ(p1.stacksize() + p2.stacksize(), card::DECK_SIZE);
+
+        // the cap stays across reset()
+        game.reset(p1, p2, 2);
+        game.fastForward();
+        CHECK(game.ending() == GameBase::Ending::Capped);
+        CHECK_EQ(game.turns(), 10);
+        CHECK_EQ(GameBase::endingName(game.ending()), "capped");
+    }
+}
+
+TEST_CASE("State Hash") {
+    Player p1("Alice");
+    Player p2("Bob");
+
+    SUBCASE("incremental hash matches a rehash after every turn") {
+        const std::uint64_t games = 100000;
+        std::uint64_t turns = 0;
+        std::uint64_t mismatches = 0;
+        std::vector<std::uint64_t> deals;
+        deals.reserve(games);
+        for (std::uint64_t seed = 0; seed < games; ++seed) {
+            Game game(p1, p2, seed);
+            deals.push_back(game.hash());
+            mismatches += game.hash() != game.rehash();
+            while (!game.finished()) {
+                game.playTurn();
+                ++turns;
+                mismatches += game.hash() != game.rehash();
+            }
+        }
+        CHECK(turns > games);
+        CHECK_EQ(mismatches, 0);
+        // different deals, different hashes
+        std::sort(deals.begin(), deals.end());
+        CHECK(std::adjacent_find(deals.begin(), deals.end()) == deals.end());
+    }
+
+    SUBCASE("reshuffling") {
+        std::uint64_t mismatches = 0;
+        for (std::uint64_t seed = 0; seed < 500; ++seed) {
+            ReshuffleGame shuffled(p1, p2, seed);
+            while (!shuffled.finished()) {
+                shuffled.playTurn();
+                mismatches += shuffled.hash() != shuffled.rehash();
+            }
+            RecycleGame recycled(p1, p2, seed);
+            while (!recycled.finished()) {
+                recycled.playTurn();
+                mismatches += recycled.hash() != recycled.rehash();
+            }
+        }
+        CHECK_EQ(mismatches, 0);
+    }
+}
+
+TEST_CASE("Outcome Cache") {
+    Player p1("Alice");
+    Player p2("Bob");
+
+    SUBCASE("a hit ends the game like playing it") {
+        OutcomeCache cache(1024);
+        for (std::uint64_t seed = 0; seed < 300; ++seed) {
+            Game played(p1, p2, seed);
+            played.playAll(cache);
+            CHECK_FALSE(played.lastTurn().empty());
+            const int p1Taken = p1.cardesTaken();
+
+            Game cached(p1, p2, seed);
+            cached.playAll(cache);
+            REQUIRE(cached.finished());
+            CHECK_EQ(cached.turns(), played.turns());
+            CHECK_EQ(cached.draws(), played.draws());
+            CHECK_EQ(cached.winner(), played.winner());
+            CHECK_EQ(cached.cardsTaken(0), played.cardsTaken(0));
+            CHECK_EQ(cached.cardsTaken(1), played.cardsTaken(1));
+            CHECK(cached.warDepths() == played.warDepths());
+            CHECK_EQ(cached.hash(), played.hash());
+            CHECK_EQ(p1.cardesTaken(), p1Taken);
+            CHECK_EQ(p1.stacksize(), 0);
+            // nothing was played
+            CHECK(cached.lastTurn().empty());
+            CHECK(cached.lastPot().empty());
+        }
+        const OutcomeCache::Stats stats = cache.stats();
+        CHECK_EQ(stats.misses, 300);
+        CHECK_EQ(stats.hits, 300);
+        CHECK_EQ(stats.hitRate(), 0.5);
+        CHECK_EQ(cache.size(), 300);
+
+        // another variant plays the same deal differently
+        AceHighGame aceHigh(p1, p2, 0);
+        aceHigh.playAll(cache);
+        CHECK_EQ(cache.stats().misses, 301);
+
+        // a started game just plays on
+        Game started(p1, p2, 1);
+        started.playTurn();
+        started.playAll(cache);
+        CHECK(started.finished());
+        CHECK_EQ(cache.stats().hits, 300);
+    }
+
+    SUBCASE("bounded") {
+        OutcomeCache cache(20);
+        CHECK_EQ(cache.capacity(), 32);
+        for (std::uint64_t seed = 0; seed < 1000; ++seed) {
+            Game game(p1, p2, seed);
+            game.playAll(cache);
+        }
+        CHECK(cache.size() <= cache.capacity());
+        const OutcomeCache::Stats stats = cache.stats();
+        CHECK_EQ(stats.insertions, 1000);
+        CHECK_EQ(stats.evictions, 1000 - cache.size());
+
+        cache.clear();
+        CHECK_EQ(cache.size(), 0);
+        CHECK_EQ(cache.stats().insertions, 0);
+    }
+
+    SUBCASE("shared by threads") {
+        const std::uint64_t games = 500;
+        OutcomeCache cache(games);
+        std::vector<int> expected(games);
+        for (std::uint64_t seed = 0; seed < games; ++seed) {
+            Game game(p1, p2, seed);
+            game.fastForward();
+            expected[seed] = game.turns() * 100 + game.cardsTaken(0);
+        }
+
+        const unsigned threads = 4;
+        std::atomic<int> wrong{0};
+        std::vector<std::thread> workers;
+        for (unsigned t = 0; t < threads; ++t) {
+            workers.emplace_back([&cache, &expected, &wrong, t]() {
+                Player first("P1");
+                Player second("P2");
+                for (std::uint64_t i = 0; i < games; ++i) {
+                    const std::uint64_t seed = (i + t * 97) % games;
+                    Game game(first, second, seed);
+                    game.playAll(cache);
+                    if (game.turns() * 100 + game.cardsTaken(0) != expected[seed]) {
+                        ++wrong;
+                    }
+                }
+            });
+        }
+        for (std::thread &worker : workers) {
+            worker.join();
+        }
+        CHECK_EQ(wrong.load(), 0);
+        const OutcomeCache::Stats stats = cache.stats();
+        CHECK_EQ(stats.hits + stats.misses, threads * games);
+        CHECK(stats.hits > 0);
+    }
+
+    SUBCASE("colliding hashes don't share an entry") {
+        OutcomeCache cache(64);
+        const OutcomeKey first{*canonical::parseRanks("23456789TJQKA"), 1};
+        // the rules id is chosen so both keys hash alike
+        const canonical::RankKey ranks = *canonical::parseRanks("A23456789TJQK");
+        const OutcomeKey second{ranks, first.hash() ^ ranks.hash()};
+        REQUIRE_EQ(first.hash(), second.hash());
+
+        GameResult result;
+        result.turns = 7;
+        cache.insert(first, result);
+        CHECK_FALSE(cache.find(second).has_value());
+        REQUIRE(cache.find(first).has_value());
+        CHECK_EQ(cache.find(first)->turns, 7);
+        result.turns = 9;
+        cache.insert(second, result);
+        CHECK_EQ(cache.size(), 2);
+        CHECK_EQ(cache.find(first)->turns, 7);
+        CHECK_EQ(cache.find(second)->turns, 9);
+    }
+}
+
+TEST_CASE("Result Store") {
+    const std::string path =
+        (std::filesystem::temp_directory_path() / ("results-" + std::to_string(std::random_device{}()) + ".bin"))
+            .string();
+
+    SUBCASE("a batch skips the stored seeds, across reopening") {
+        BatchOptions options;
+        options.games = 300;
+        options.seed = 11;
+        BatchStats first;
+        {
+            ResultStore store(path, ResultStore::Mode::Write, 500);
+            CHECK(store.capacity() >= 500);
+            options.store = &store;
+            first = runBatch(options);
+            CHECK_EQ(first.stored, 0);
+            CHECK_EQ(store.size(), 300);
+        }
+
+        ResultStore store(path, ResultStore::Mode::Write);
+        CHECK_EQ(store.size(), 300);
+        options.store = &store;
+        options.games = 400;
+        options.threads = 3;
+        const BatchStats second = runBatch(options);
+        CHECK_EQ(second.stored, 300);
+        CHECK_EQ(store.size(), 400);
+
+        options.store = nullptr;
+        const BatchStats played = runBatch(options);
+        CHECK_EQ(second.p1Wins, played.p1Wins);
+        CHECK_EQ(second.p2Wins, played.p2Wins);
+        CHECK_EQ(second.ties, played.ties);
+        CHECK_EQ(second.turns, played.turns);
+        CHECK_EQ(second.draws, played.draws);
+        CHECK(second.warDepths == played.warDepths);
+
+        // readers open the file while the writer has it
+        const ResultStore reader(path, ResultStore::Mode::Read);
+        Player p1("Alice");
+        Player p2("Bob");
+        Game game(p1, p2, 11);
+        game.fastForward();
+        const std::optional<StoredResult> found = reader.find(Variant::Classic, 11);
+        REQUIRE(found.has_value());
+        CHECK_EQ(found->turns, game.turns());
+        CHECK_EQ(found->draws, game.draws());
+        CHECK_EQ(found->depths, game.warDepths().size());
+        CHECK_FALSE(reader.find(Variant::AceHigh, 11).has_value());
+        CHECK_FALSE(reader.find(Variant::Classic, 411).has_value());
+    }
+
+    SUBCASE("bounded") {
+        ResultStore store(path, ResultStore::Mode::Write, 10);
+        StoredResult result;
+        std::uint64_t seed = 0;
+        while (store.insert(Variant::Recycle, seed, result)) {
+            ++seed;
+        }
+        CHECK_EQ(seed, store.capacity());
+        CHECK_EQ(store.size(), store.capacity());
+        // an existing seed is still found, and inserting it again is a no-op
+        CHECK(store.insert(Variant::Recycle, 0, result));
+        CHECK_FALSE(store.insert(Variant::Reshuffle, 0, result));
+
+        const ResultStore reader(path, ResultStore::Mode::Read);
+        CHECK_FALSE(const_cast<ResultStore &>(reader).insert(Variant::Recycle, seed, result));
+    }
+
+    SUBCASE("readers see whole results while a writer inserts") {
+        ResultStore store(path, ResultStore::Mode::Write, 20000);
+        const ResultStore reader(path, ResultStore::Mode::Read);
+        const std::uint32_t seeds = 20000;
+        std::atomic<bool> done{false};
+        std::atomic<int> torn{0};
+        std::atomic<int> seen{0};
+
+        std::thread readerThread([&]() {
+            std::mt19937 rng(1);
+            while (!done.load()) {
+                const std::uint32_t seed = rng() % seeds;
+                if (const std::optional<StoredResult> found = reader.find(Variant::Classic, seed)) {
+                    ++seen;
+                    torn += found->turns != seed || found->warDepths.back() != seed;
+                }
+            }
+        });
+        for (std::uint32_t seed = 0; seed < seeds; ++seed) {
+            StoredResult result;
+            result.turns = seed;
+            result.warDepths.back() = seed;
+            REQUIRE(store.insert(Variant::Classic, seed, result));
+        }
+        done = true;
+        readerThread.join();
+        CHECK_EQ(torn.load(), 0);
+        CHECK(seen.load() > 0);
+    }
+
+    SUBCASE("other files are refused") {
+        {
+            std::ofstream out(path);
+            out << "not a result store";
+        }
+        CHECK_THROWS_AS(ResultStore(path, ResultStore::Mode::Read), std::runtime_error);
+        CHECK_THROWS_AS(ResultStore(path, ResultStore::Mode::Write), std::runtime_error);
+        CHECK_THROWS_AS(ResultStore(path + ".missing", ResultStore::Mode::Read), std::runtime_error);
+    }
+
+    SUBCASE("stores of builds that deal differently are refused") {
+        { const ResultStore store(path, ResultStore::Mode::Write, 10); }
+        {
+            // the header's deal fingerprint, after the magic, version, slot
+            // size, slot count and size
+            std::fstream file(path, std::ios::in | std::ios::out | std::ios::binary);
+            file.seekp(32);
+            const std::uint64_t other = 1;
+            file.write(reinterpret_cast<const char *>(&other), sizeof(other));
+        }
+        CHECK_THROWS_AS(ResultStore(path, ResultStore::Mode::Read), std::runtime_error);
+        CHECK_THROWS_AS(ResultStore(path, ResultStore::Mode::Write), std::runtime_error);
+    }
+
+    SUBCASE("a store holds the games of one turn cap") {
+        {
+            ResultStore store(path, ResultStore::Mode::Write, 10, 500);
+            CHECK_EQ(store.turnCap(), 500);
+            BatchOptions options;
+            options.games = 5;
+            options.variant = Variant::Reshuffle;
+            options.store = &store;
+            CHECK_THROWS_AS(runBatch(options), std::invalid_argument);
+            options.turnCap = 500;
+            CHECK_EQ(runBatch(options).games, 5);
+        }
+        CHECK_THROWS_AS(ResultStore(path, ResultStore::Mode::Read), std::runtime_error);
+        CHECK_THROWS_AS(ResultStore(path, ResultStore::Mode::Write, 10, 600), std::runtime_error);
+        CHECK_EQ(ResultStore(path, ResultStore::Mode::Read, 10, 500).size(), 5);
+    }
+
+    SUBCASE("one writer at a time") {
+        const ResultStore store(path, ResultStore::Mode::Write);
+        CHECK_THROWS_AS(ResultStore(path, ResultStore::Mode::Write), std::runtime_error);
+    }
+
+    std::filesystem::remove(path);
+}
+
+namespace {
+    // turns, wars and the first player's cards taken in a classic game on
+    // deal, played with turn::play().
+    std::array<unsigned, 3> playDeal(const std::array<std::uint8_t, card::DECK_SIZE> &deal) {
+        const unsigned hand = card::DECK_SIZE / 2;
+        std::array<std::uint8_t, card::DECK_SIZE + 2> pot{};
+        std::array<unsigned, 3> counts{};
+        for (unsigned drawn = 0; drawn < hand;) {
+            const turn::Result result = turn::play(deal.data(), deal.data() + hand, hand, drawn, pot.data());
+            ++counts[0];
+            counts[1] += result.wars;
+            counts[2] += result.split ? result.potSize / 2 : (result.compare > 0 ? result.potSize : 0);
+            drawn = result.drawn;
+        }
+        return counts;
+    }
+}
+
+TEST_CASE("Canonical Deals") {
+    std::mt19937_64 rng(42);
+    std::array<std::uint8_t, card::DECK_SIZE> deal;
+    std::iota(deal.begin(), deal.end(), std::uint8_t{0});
+
+    SUBCASE("suits don't change the key or the game") {
+        std::uint64_t full = 1;
+        for (int rank = 0; rank < canonical::RANKS; ++rank) {
+            full *= 24;
+        }
+        for (int round = 0; round < 200; ++round) {
+            std::shuffle(deal.begin(), deal.end(), rng);
+            const canonical::Canonical canonical = canonical::canonicalize(deal.data(), deal.size());
+            CHECK_EQ(canonical.multiplicity, full);
+            for (std::size_t i = 0; i < deal.size(); ++i) {
+                CHECK_EQ(canonical.key.rank(i) + card::MIN_RANK, card::fromPacked(deal[i]).rank());
+            }
+
+            // a suit permutation for every rank
+            std::array<std::array<std::uint8_t, card::SUITS>, canonical::RANKS> suits;
+            for (auto &order : suits) {
+                std::iota(order.begin(), order.end(), std::uint8_t{0});
+                std::shuffle(order.begin(), order.end(), rng);
+            }
+            std::array<std::uint8_t, card::DECK_SIZE> permuted;
+            for (std::size_t i = 0; i < deal.size(); ++i) {
+                const auto rank = static_cast<std::size_t>(deal[i] / card::SUITS);
+                permuted[i] = static_cast<std::uint8_t>(rank * card::SUITS + suits[rank][deal[i] % card::SUITS]);
+            }
+            const canonical::Canonical other = canonical::canonicalize(permuted.data(), permuted.size());
+            CHECK(other.key == canonical.key);
+            CHECK_EQ(other.key.hash(), canonical.key.hash());
+            CHECK(playDeal(permuted) == playDeal(deal));
+
+            std::array<std::uint8_t, card::DECK_SIZE> first;
+            canonical::representative(canonical.key, first.data());
+            CHECK(canonical::canonicalize(first.data(), first.size()).key == canonical.key);
+            CHECK(playDeal(first) == playDeal(deal));
+        }
+    }
+
+    SUBCASE("different ranks, different keys") {
+        std::shuffle(deal.begin(), deal.end(), rng);
+        const canonical::RankKey key = canonical::canonicalize(deal.data(), deal.size()).key;
+        std::size_t other = 1;
+        while (deal[other] / card::SUITS == deal[0] / card::SUITS) {
+            ++other;
+        }
+        std::swap(deal[0], deal[other]);
+        const canonical::RankKey swapped = canonical::canonicalize(deal.data(), deal.size()).key;
+        CHECK_FALSE(swapped == key);
+        CHECK_NE(swapped.hash(), key.hash());
+        // a prefix is another deal
+        CHECK_FALSE(canonical::canonicalize(deal.data(), 51).key == swapped);
+    }
+
+    SUBCASE("reduced decks") {
+        // three 2s, two 3s, a King and two Aces
+        const std::array<std::uint8_t, 8> cards = {0, 1, 2, 4, 5, 44, 48, 50};
+        const canonical::Canonical canonical = canonical::canonicalize(cards.data(), cards.size());
+        CHECK_EQ(canonical.multiplicity, 6 * 2 * 1 * 2);
+        CHECK_EQ(canonical.key.length, 8);
+        CHECK_EQ(canonical::canonicalize(cards.data(), 0).multiplicity, 1);
+    }
+}
+
+namespace {
+    // the winner of a game on hands, 1 + seat or 0 on a tie, turn by turn
+    // through referenceTurn().
+    template <typename Rules>
+    std::uint8_t referenceWinner(const std::vector<std::uint8_t> &first, const std::vector<std::uint8_t> &second) {
+        std::array<std::size_t, 2> taken{};
+        for (std::size_t drawn = 0; drawn < first.size();) {
+            const auto from = static_cast<std::ptrdiff_t>(drawn);
+            const ReferenceTurn turn = referenceTurn<Rules>(std::vector<std::uint8_t>(first.begin() + from, first.end()),
+                                                            std::vector<std::uint8_t>(second.begin() + from, second.end()));
+            if (turn.split) {
+                taken[0] += turn.pot.size() / 2;
+                taken[1] += turn.pot.size() / 2;
+            } else {
+                taken[turn.compare > 0 ? 0 : 1] += turn.pot.size();
+            }
+            drawn += turn.drawn;
+        }
+        return taken[0] == taken[1] ? 0 : (taken[0] > taken[1] ? 1 : 2);
+    }
+
+    // every order of the actual cards of deck, suits and all.
+    template <typename Rules>
+    std::array<std::uint64_t, 3> everyCardOrder(const std::vector<int> &ranks, int suits) {
+        std::vector<std::uint8_t> cards;
+        for (int rank : ranks) {
+            for (int suit = 0; suit < suits; ++suit) {
+                cards.push_back(card(rank, static_cast<Suit>(suit)).packed());
+            }
+        }
+        std::sort(cards.begin(), cards.end());
+        const auto hand = static_cast<std::ptrdiff_t>(cards.size() / 2);
+        std::array<std::uint64_t, 3> winners{};
+        do {
+            ++winners[referenceWinner<Rules>(std::vector<std::uint8_t>(cards.begin(), cards.begin() + hand),
+                                             std::vector<std::uint8_t>(cards.begin() + hand, cards.end()))];
+        } while (std::next_permutation(cards.begin(), cards.end()));
+        return winners;
+    }
+}
+
+TEST_CASE("Reduced Deck Enumeration") {
+    SUBCASE("deals up to suits") {
+        const ReducedDeck jqk({11, 12, 13}, 4);
+        CHECK_EQ(jqk.cards(), 12);
+        CHECK_EQ(jqk.deals(), 34650);
+        CHECK_EQ(jqk.multiplicity(), 24 * 24 * 24);
+        const ReducedDeck pairs({5, 2, 4, 3}, 2);
+        CHECK_EQ(pairs.deals(), 2520);
+        CHECK_EQ(pairs.multiplicity(), 16);
+
+        CHECK_THROWS_AS(ReducedDeck({2, 2}, 2), std::invalid_argument);
+        CHECK_THROWS_AS(ReducedDeck({2, 3, 4}, 1), std::invalid_argument);
+        CHECK_THROWS_AS(ReducedDeck({1, 2}, 2), std::invalid_argument);
+        CHECK_THROWS_AS(ReducedDeck({2, 3}, 5), std::invalid_argument);
+        CHECK_THROWS_AS(ReducedDeck({2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14}, 4), std::overflow_error);
+    }
+
+    SUBCASE("unranking walks the orders in turn") {
+        const ReducedDeck deck({2, 3, 9, 14}, 2);
+        std::array<int, 8> ranks = {0, 0, 1, 1, 7, 7, 12, 12};
+        int wrong = 0;
+        for (std::uint64_t index = 0; index < deck.deals(); ++index) {
+            const canonical::RankKey key = deck.deal(index);
+            for (std::size_t i = 0; i < ranks.size(); ++i) {
+                wrong += key.rank(i) != ranks[i];
+            }
+            CHECK_EQ(std::next_permutation(ranks.begin(), ranks.end()), index + 1 < deck.deals());
+        }
+        CHECK_EQ(wrong, 0);
+        CHECK_EQ(canonical::rankString(deck.deal(deck.deals() - 1)), "AA993322");
+    }
+
+    SUBCASE("exact probabilities of every order of the cards") {
+        const std::vector<int> ranks = {2, 3, 9, 14};
+        const ReducedDeck deck(ranks, 2);
+        const std::uint64_t orders = 40320; // 8!
+
+        EnumerationOptions options;
+        options.threads = 3;
+        const std::array<std::uint64_t, 3> classic = everyCardOrder<ClassicRules>(ranks, 2);
+        const Enumeration enumerated = enumerate(deck, options);
+        CHECK_EQ(enumerated.ties * deck.multiplicity(), classic[0]);
+        CHECK_EQ(enumerated.p1Wins * deck.multiplicity(), classic[1]);
+        CHECK_EQ(enumerated.p2Wins * deck.multiplicity(), classic[2]);
+        const std::uint64_t divisor = std::gcd(classic[1], orders);
+        CHECK(enumerated.probability(enumerated.p1Wins) == Fraction{classic[1] / divisor, orders / divisor});
+
+        options.variant = Variant::FaceDown2;
+        const std::array<std::uint64_t, 3> faceDown = everyCardOrder<FaceDownRules<2>>(ranks, 2);
+        const Enumeration twoDown = enumerate(deck, options);
+        CHECK_EQ(twoDown.ties * deck.multiplicity(), faceDown[0]);
+        CHECK_EQ(twoDown.p1Wins * deck.multiplicity(), faceDown[1]);
+
+        options.variant = Variant::Recycle;
+        CHECK_THROWS_AS(enumerate(deck, options), std::invalid_argument);
+    }
+
+    SUBCASE("any split across threads gives the same table") {
+        const ReducedDeck deck({11, 12, 13}, 4);
+        EnumerationOptions options;
+        options.table = true;
+        const Enumeration one = enumerate(deck, options);
+        options.threads = 7;
+        const Enumeration seven = enumerate(deck, options);
+        CHECK_EQ(seven.p1Wins, one.p1Wins);
+        CHECK_EQ(seven.ties, one.ties);
+        CHECK_EQ(seven.turns, one.turns);
+        CHECK_EQ(seven.draws, one.draws);
+        REQUIRE_EQ(one.table.size(), deck.deals());
+        CHECK(seven.table == one.table);
+
+        std::array<std::uint64_t, 3> winners{};
+        for (const DealOutcome &outcome : one.table) {
+            ++winners[outcome.winner];
+        }
+        CHECK_EQ(winners[0], one.ties);
+        CHECK_EQ(winners[1], one.p1Wins);
+        CHECK_EQ(winners[2], one.p2Wins);
+        // the players are symmetric, and the three probabilities add up
+        CHECK_EQ(one.p1Wins, one.p2Wins);
+        CHECK_EQ(one.p1Wins + one.p2Wins + one.ties, one.deals);
+    }
+}
+
+TEST_CASE("Deal Injection") {
+    Player p1("Alice");
+    Player p2("Bob");
+    Player p3("Carol");
+    Player p4("Dave");
+    // the deal a seed gets
+    const auto shuffled = [](std::uint64_t seed) {
+        std::array<std::uint8_t, card::DECK_SIZE> deck;
+        std::iota(deck.begin(), deck.end(), std::uint8_t{0});
+        std::mt19937_64 rng(seed);
+        std::shuffle(deck.begin(), deck.end(), rng);
+        return deck;
+    };
+    const auto packedPot = [](const Game &game) {
+        std::vector<std::uint8_t> packed;
+        for (const card &played : game.lastPot()) {
+            packed.push_back(played.packed());
+        }
+        return packed;
+    };
+
+    SUBCASE("a given deal plays like the seed that shuffles it") {
+        for (std::uint64_t seed = 0; seed < 200; ++seed) {
+            const std::array<std::uint8_t, card::DECK_SIZE> deck = shuffled(seed);
+            Game seeded(p1, p2, seed);
+            Game given(p3, p4, deck);
+            CHECK_EQ(given.hash(), seeded.hash());
+            while (!seeded.finished()) {
+                seeded.playTurn();
+                given.playTurn();
+                CHECK(packedPot(given) == packedPot(seeded));
+            }
+            CHECK(given.finished());
+            CHECK_EQ(given.cardsTaken(0), seeded.cardsTaken(0));
+            CHECK_EQ(given.cardsTaken(1), seeded.cardsTaken(1));
+
+            // suits don't matter, so the ranks alone play the same game
+            const std::string ranks = canonical::rankString(canonical::canonicalize(deck.data(), deck.size()).key);
+            Game ranked(p1, p2, ranks);
+            ranked.fastForward();
+            CHECK_EQ(ranked.turns(), seeded.turns());
+            CHECK_EQ(ranked.draws(), seeded.draws());
+            CHECK_EQ(ranked.cardsTaken(0), seeded.cardsTaken(0));
+        }
+
+        // the recycled piles don't depend on the seed either
+        for (std::uint64_t seed = 0; seed < 20; ++seed) {
+            RecycleGame seeded(p1, p2, seed);
+            RecycleGame given(p3, p4, shuffled(seed));
+            seeded.fastForward();
+            given.fastForward();
+            CHECK_EQ(given.turns(), seeded.turns());
+            CHECK_EQ(given.ending(), seeded.ending());
+        }
+        // and with SHUFFLE_WON a given deal reshuffles as after seed 0
+        ReshuffleGame seeded(p1, p2, 0);
+        ReshuffleGame given(p3, p4, shuffled(0));
+        seeded.fastForward();
+        given.fastForward();
+        CHECK_EQ(given.turns(), seeded.turns());
+        CHECK_EQ(given.hash(), seeded.hash());
+    }
+
+    SUBCASE("rank strings") {
+        // p1 holds 2 to 8, p2 holds 8 to Ace: no 2 ever meets an Ace
+        Game sorted(p1, p2, "22223333444455556666777788" "88999TTTTJJJJQQQQKKKKAAAA" "9");
+        sorted.playTurn();
+        const std::vector<card> pot = sorted.lastPot();
+        REQUIRE_EQ(pot.size(), 2);
+        CHECK_EQ(pot[0].packed(), card(2, Suit::Hearts).packed());
+        CHECK_EQ(pot[1].packed(), card(8, Suit::Clubs).packed());
+        sorted.playAll();
+        CHECK_EQ(sorted.turns(), 26);
+        CHECK_EQ(sorted.draws(), 0);
+        CHECK_EQ(sorted.winner(), &p2);
+        CHECK_EQ(p2.cardesTaken(), 26);
+    }
+
+    SUBCASE("wrong deals are refused before the players are taken") {
+        std::array<std::uint8_t, card::DECK_SIZE> deck = shuffled(3);
+        CHECK_THROWS_AS(Game(p1, p2, std::span<const std::uint8_t>(deck).first(51)), std::invalid_argument);
+        deck[7] = deck[8];
+        CHECK_THROWS_AS(Game(p1, p2, deck), std::invalid_argument);
+        deck[7] = card::DECK_SIZE;
+        CHECK_THROWS_AS(Game(p1, p2, deck), std::invalid_argument);
+
+        const std::string ranks = "2222333344445555666677778888999TTTTJJJJQQQQKKKKAAAA";
+        CHECK_NOTHROW(Game(p1, p2, ranks + "9"));
+        CHECK_THROWS_AS(Game(p1, p2, ranks + "A"), std::invalid_argument); // five Aces
+        CHECK_THROWS_AS(Game(p1, p2, ranks), std::invalid_argument);       // 51 cards
+        CHECK_THROWS_AS(Game(p1, p2, ranks + "1"), std::invalid_argument);
+        CHECK_THROWS_AS(Game(p1, p2, ranks + "99"), std::invalid_argument);
+
+        // both players are still free
+        Game game(p1, p2, 3);
+        CHECK_THROWS_AS(game.reset(p1, p2, std::span<const std::uint8_t>(deck)), std::invalid_argument);
+        game.playAll();
+        CHECK(game.finished());
+    }
+
+    SUBCASE("reset to a given deal") {
+        Game game(p1, p2, 5);
+        game.playAll();
+        game.reset(p1, p2, shuffled(9));
+        game.playAll();
+        Game fresh(p1, p2, 9);
+        fresh.playAll();
+        CHECK_EQ(game.turns(), fresh.turns());
+        CHECK_EQ(game.hash(), fresh.hash());
+        CHECK(game.warDepths() == fresh.warDepths());
+    }
+}
+
+TEST_CASE("Deal Corpus") {
+    Player p1("Alice");
+    Player p2("Bob");
+    const std::string path =
+        (std::filesystem::temp_directory_path() / ("deals-" + std::to_string(std::random_device{}()) + ".bin"))
+            .string();
+    const auto sameStats = [](const BatchStats &a, const BatchStats &b) {
+        CHECK_EQ(a.games, b.games);
+        CHECK_EQ(a.p1Wins, b.p1Wins);
+        CHECK_EQ(a.p2Wins, b.p2Wins);
+        CHECK_EQ(a.ties, b.ties);
+        CHECK_EQ(a.turns, b.turns);
+        CHECK_EQ(a.draws, b.draws);
+        CHECK(a.warDepths == b.warDepths);
+    };
+
+    SUBCASE("a corpus of seeds replays them, in either format") {
+        for (DealCorpus::Format format : {DealCorpus::Format::Cards, DealCorpus::Format::Ranks}) {
+            CorpusOptions options;
+            options.format = format;
+            options.property = CorpusProperty::None;
+            options.perStratum = 200;
+            options.seed = 9;
+            CHECK_EQ(writeCorpus(path, options), 200);
+
+            const DealCorpus corpus(path);
+            CHECK_EQ(corpus.size(), 200);
+            CHECK_EQ(corpus.strata(), 0);
+            std::array<std::uint8_t, card::DECK_SIZE> scratch{};
+            const std::span<const std::uint8_t> first = corpus.deal(0, scratch.data());
+            CHECK_EQ(first.data() == scratch.data(), format == DealCorpus::Format::Ranks);
+
+            BatchOptions batch;
+            batch.games = 150;
+            batch.seed = 9;
+            const BatchStats seeded = runBatch(batch);
+            batch.corpus = &corpus;
+            batch.seed = 0;
+            batch.threads = 3;
+            sameStats(runBatch(batch), seeded);
+
+            // a corpus batch's seed is where in the corpus it starts
+            batch.seed = 50;
+            const BatchStats later = runBatch(batch);
+            batch.corpus = nullptr;
+            batch.seed = 59;
+            sameStats(later, runBatch(batch));
+        }
+    }
+
+    SUBCASE("every deal is in the stratum it is filed under") {
+        CorpusOptions options;
+        options.format = DealCorpus::Format::Ranks;
+        options.property = CorpusProperty::Aces;
+        options.perStratum = 40;
+        writeCorpus(path, options);
+        {
+            const DealCorpus corpus(path);
+            CHECK_EQ(corpus.property(), CorpusProperty::Aces);
+            REQUIRE_EQ(corpus.strata(), 5);
+            std::array<std::uint8_t, card::DECK_SIZE> scratch{};
+            for (std::size_t i = 0; i < corpus.size(); ++i) {
+                const auto deal = corpus.deal(i, scratch.data());
+                const auto aces = std::count_if(deal.begin(), deal.begin() + card::DECK_SIZE / 2,
+                                                [](std::uint8_t packed) { return packed / card::SUITS == 12; });
+                CHECK_EQ(static_cast<std::size_t>(aces), i / corpus.perStratum());
+            }
+        }
+
+        options.format = DealCorpus::Format::Cards;
+        options.property = CorpusProperty::Wars;
+        options.perStratum = 10;
+        writeCorpus(path, options);
+        const DealCorpus corpus(path);
+        REQUIRE_EQ(corpus.strata(), MAX_WARS + 1);
+        Player p1("Alice");
+        Player p2("Bob");
+        std::array<std::uint8_t, card::DECK_SIZE> scratch{};
+        for (std::size_t i = 0; i < corpus.size(); ++i) {
+            Game game(p1, p2, corpus.deal(i, scratch.data()));
+            game.fastForward();
+            CHECK_EQ(std::min(game.draws(), static_cast<int>(MAX_WARS)), static_cast<int>(i / corpus.perStratum()));
+        }
+    }
+
+    SUBCASE("wrong files and uses are refused") {
+        CHECK_THROWS_AS(DealCorpus{path}, std::runtime_error);
+        {
+            std::ofstream out(path, std::ios::binary);
+            out << std::string(100, 'x');
+        }
+        CHECK_THROWS_AS(DealCorpus{path}, std::runtime_error);
+
+        CorpusOptions options;
+        options.property = CorpusProperty::None;
+        options.perStratum = 4;
+        writeCorpus(path, options);
+        std::filesystem::resize_file(path, std::filesystem::file_size(path) - 1);
+        CHECK_THROWS_AS(DealCorpus{path}, std::runtime_error);
+
+        {
+            DealCorpusWriter writer(path, DealCorpus::Format::Cards);
+            std::array<std::uint8_t, card::DECK_SIZE> deal{};
+            std::iota(deal.begin(), deal.end(), std::uint8_t{0});
+            writer.append(deal);
+            CHECK_THROWS_AS(writer.append(std::span<const std::uint8_t>(deal).first(26)), std::invalid_argument);
+        }
+        const DealCorpus corpus(path);
+        CHECK_EQ(corpus.size(), 1);
+        BatchOptions batch;
+        batch.corpus = &corpus;
+        batch.games = 2;
+        CHECK_THROWS_AS(runBatch(batch), std::invalid_argument);
+
+        options.property = CorpusProperty::Wars;
+        options.variant = Variant::Reshuffle;
+        CHECK_THROWS_AS(writeCorpus(path, options), std::invalid_argument);
+    }
+
+    SUBCASE("deals that aren't whole decks are refused when they're read") {
+        // rewrites byte at of the corpus at path to value.
+        const auto corrupt = [&path](std::size_t at, char value) {
+            std::fstream file(path, std::ios::binary | std::ios::in | std::ios::out);
+            file.seekp(static_cast<std::streamoff>(at));
+            file.put(value);
+        };
+        const std::size_t header = 64;
+        std::array<std::uint8_t, card::DECK_SIZE> scratch{};
+        CorpusOptions options;
+        options.property = CorpusProperty::None;
+        options.perStratum = 3;
+
+        options.format = DealCorpus::Format::Ranks;
+        writeCorpus(path, options);
+        // a rank of 14 in the last deal
+        corrupt(header + 2 * DealCorpus::RANK_BYTES + 5, static_cast<char>(0xe0));
+        {
+            const DealCorpus corpus(path);
+            CHECK_NOTHROW(corpus.deal(1, scratch.data()));
+            CHECK_THROWS_AS(corpus.deal(2, scratch.data()), std::runtime_error);
+        }
+        // five 2s and three Aces: every rank is valid
+        writeCorpus(path, options);
+        corrupt(header + DealCorpus::RANK_BYTES, 0x00);
+        corrupt(header + DealCorpus::RANK_BYTES + 1, 0x00);
+        corrupt(header + DealCorpus::RANK_BYTES + 2, 0x00);
+        corrupt(header + DealCorpus::RANK_BYTES + 3, 0x00);
+        corrupt(header + DealCorpus::RANK_BYTES + 4, 0x00);
+        {
+            const DealCorpus corpus(path);
+            CHECK_NOTHROW(corpus.deal(0, scratch.data()));
+            CHECK_THROWS_AS(corpus.deal(1, scratch.data()), std::runtime_error);
+        }
+
+        options.format = DealCorpus::Format::Cards;
+        writeCorpus(path, options);
+        corrupt(header + 7, 52);
+        {
+            const DealCorpus corpus(path);
+            CHECK_THROWS_AS(Game(p1, p2, corpus.deal(0, scratch.data())), std::invalid_argument);
+            CHECK_NOTHROW(Game(p1, p2, corpus.deal(1, scratch.data())));
+        }
+        writeCorpus(path, options);
+        std::uint8_t repeated = 0;
+        {
+            const DealCorpus corpus(path);
+            repeated = corpus.deal(1, scratch.data())[0];
+        }
+        corrupt(header + card::DECK_SIZE + 1, static_cast<char>(repeated));
+        {
+            const DealCorpus corpus(path);
+            CHECK_THROWS_AS(Game(p1, p2, corpus.deal(1, scratch.data())), std::invalid_argument);
+        }
+    }
+
+    std::filesystem::remove(path);
+}
+
+TEST_CASE("Lazy Deal") {
+    Player p1("Alice");
+    Player p2("Bob");
+    Player p3("Carol");
+    Player p4("Dave");
+
+    SUBCASE("dealing as the turns go plays one whole deal") {
+        std::uint64_t mismatches = 0;
+        for (std::uint64_t seed = 0; seed < 300; ++seed) {
+            std::array<int, card::DECK_SIZE> seen{};
+            Game lazy(p1, p2, seed, LazyDeal{});
+            const std::uint64_t dealt = lazy.hash();
+            mismatches += dealt != lazy.rehash();
+            while (!lazy.finished()) {
+                lazy.playTurn();
+                mismatches += lazy.hash() != lazy.rehash();
+                for (const card &put : lazy.lastPot()) {
+                    ++seen[put.packed()];
+                }
+            }
+            CHECK(std::all_of(seen.begin(), seen.end(), [](int count) { return count == 1; }));
+
+            // the same seed dealt in one go, as fastForward() does
+            Game whole(p3, p4, seed, LazyDeal{});
+            CHECK_EQ(whole.hash(), dealt);
+            whole.fastForward();
+            CHECK_EQ(whole.turns(), lazy.turns());
+            CHECK_EQ(whole.draws(), lazy.draws());
+            CHECK_EQ(whole.cardsTaken(0), lazy.cardsTaken(0));
+            CHECK(whole.warDepths() == lazy.warDepths());
+            const std::vector<card> wholePot = whole.lastPot();
+            const std::vector<card> lazyPot = lazy.lastPot();
+            CHECK(std::equal(wholePot.begin(), wholePot.end(), lazyPot.begin(), lazyPot.end(),
+                             [](const card &a, const card &b) { return a.packed() == b.packed(); }));
+        }
+        CHECK_EQ(mismatches, 0);
+    }
+
+    SUBCASE("every card is as likely in every place") {
+        // the first card of each hand over many seeds: 250 of each card
+        // expected, with a standard deviation under 16.
+        const int games = 13000;
+        std::array<std::array<int, card::DECK_SIZE>, 2> first{};
+        for (int seed = 0; seed < games; ++seed) {
+            Game game(p1, p2, static_cast<std::uint64_t>(seed), LazyDeal{});
+            game.playTurn();
+            const std::vector<card> pot = game.lastPot();
+            CHECK_NE(pot[0].packed(), pot[1].packed());
+            ++first[0][pot[0].packed()];
+            ++first[1][pot[1].packed()];
+        }
+        for (const auto &seat : first) {
+            CHECK_GT(*std::min_element(seat.begin(), seat.end()), 250 - 80);
+            CHECK_LT(*std::max_element(seat.begin(), seat.end()), 250 + 80);
+        }
+    }
+
+    SUBCASE("whole game calls deal the rest first") {
+        OutcomeCache cache(64);
+        {
+            Game started(p1, p2, 5, LazyDeal{});
+            started.playTurn();
+            started.playAll(cache); // plays on, nothing cached
+            CHECK(started.finished());
+        }
+        GameResult played;
+        {
+            Game game(p1, p2, 5, LazyDeal{});
+            game.playAll(cache);
+            played = game.result();
+        }
+        Game hit(p1, p2, 5, LazyDeal{});
+        hit.playAll(cache);
+        CHECK_EQ(cache.stats().hits, 1);
+        CHECK(hit.result().taken == played.taken);
+
+        // reshuffling games are dealt up front, in the same order
+        ReshuffleGame shuffled(p3, p4, 5, LazyDeal{});
+        CHECK_EQ(shuffled.hash(), shuffled.rehash());
+        shuffled.fastForward();
+        CHECK(shuffled.finished());
+    }
+}
+
+TEST_CASE("Card Names") {
+    static_assert(card(12, Suit::Hearts).name() == "Queen of Hearts");
+    static_assert(card(5, Suit::Spades).name() == "5 of Spades");
+    static_assert(card::fromPacked(0).name() == "2 of Hearts");
+    static_assert(cards::ORDERED.front().name() == "2 of Hearts");
+    static_assert(cards::ORDERED.back().name() == "Ace of Spades");
+
+    const std::array<std::string, 4> suits = {"Hearts", "Diamonds", "Clubs", "Spades"};
+    const std::map<int, std::string> faces = {{11, "Jack"}, {12, "Queen"}, {13, "King"}, {14, "Ace"}};
+    for (int packed = 0; packed < card::DECK_SIZE; ++packed) {
+        const card named = card::fromPacked(static_cast<std::uint8_t>(packed));
+        const std::string rank = named.rank() > 10 ? faces.at(named.rank()) : std::to_string(named.rank());
+        CHECK_EQ(named.toString(), rank + " of " + suits[static_cast<std::size_t>(named.suit())]);
+        CHECK_EQ(named.name().data(), cards::NAMES[static_cast<std::size_t>(packed)].data());
+    }
+
+    const std::vector<card> deck = card::fullDeck();
+    REQUIRE_EQ(deck.size(), card::DECK_SIZE);
+    for (std::size_t i = 0; i < deck.size(); ++i) {
+        CHECK_EQ(deck[i].packed(), cards::ORDERED[i].packed());
+    }
+}
+
+TEST_CASE("Compile-Time Games") {
+    // the first deal of a rank string, as Game deals it (see
+    // canonical::representative()).
+    constexpr auto fromRanks = [](std::string_view ranks) {
+        std::array<std::uint8_t, card::DECK_SIZE> deck{};
+        std::array<std::uint8_t, canonical::RANKS> copies{};
+        for (std::size_t i = 0; i < ranks.size(); ++i) {
+            const std::size_t rank = canonical::RANK_SYMBOLS.find(ranks[i]);
+            deck[i] = static_cast<std::uint8_t>(rank * card::SUITS + copies[rank]++);
+        }
+        return deck;
+    };
+    constexpr auto classic = [](const std::array<std::uint8_t, card::DECK_SIZE> &deck) {
+        return turn::playOut<ClassicRules>(deck.data(), deck.data() + Dealer::HAND, Dealer::HAND);
+    };
+    constexpr auto faceDown = [](const std::array<std::uint8_t, card::DECK_SIZE> &deck) {
+        return turn::playOut<FaceDownRules<2>>(deck.data(), deck.data() + Dealer::HAND, Dealer::HAND);
+    };
+
+    // equal hands: one war after another to the end of the deck.
+    constexpr turn::Tally mirrored = classic(fromRanks("23456789TJQKA23456789TJQKA" "23456789TJQKA23456789TJQKA"));
+    static_assert(mirrored == turn::Tally{{26, 26}, 1, 13, 1});
+    static_assert(mirrored.winner() == 0);
+    // every card of the second hand is higher.
+    static_assert(classic(fromRanks("22223333444455556666777788" "88999TTTTJJJJQQQQKKKKAAAA" "9")) ==
+                  turn::Tally{{0, 26}, 26, 0, 0});
+
+    // lazy deals: wars, a tie, and splits at the end of the deck.
+    static_assert(classic(lazyDeck(10)) == turn::Tally{{17, 10}, 20, 4, 1});
+    static_assert(classic(lazyDeck(13)) == turn::Tally{{13, 13}, 18, 4, 0});
+    static_assert(classic(lazyDeck(28)) == turn::Tally{{13, 14}, 22, 3, 1});
+    static_assert(faceDown(lazyDeck(10)) == turn::Tally{{8, 19}, 17, 4, 1});
+    static_assert(faceDown(lazyDeck(10)).winner() == 2);
+
+    Player p1("Alice");
+    Player p2("Bob");
+
+    SUBCASE("games play as their compile-time tallies") {
+        for (std::uint64_t seed = 0; seed < 100; ++seed) {
+            const turn::Tally tally = classic(lazyDeck(seed));
+            Game game(p1, p2, seed, LazyDeal{});
+            game.fastForward();
+            CHECK_EQ(game.turns(), tally.turns);
+            CHECK_EQ(game.draws(), tally.wars);
+            CHECK_EQ(game.cardsTaken(0), tally.taken[0]);
+            CHECK_EQ(game.cardsTaken(1), tally.taken[1]);
+        }
+        BasicGame<FaceDownRules<2>> game(p1, p2, 10, LazyDeal{});
+        game.playAll();
+        CHECK_EQ(game.turns(), 17);
+        CHECK_EQ(game.cardsTaken(1), 19);
+        CHECK_EQ(game.winner(), &p2);
+    }
+
+    SUBCASE("rank strings play as their compile-time tallies") {
+        Game game(p1, p2, "23456789TJQKA23456789TJQKA" "23456789TJQKA23456789TJQKA");
+        game.playAll();
+        CHECK_EQ(game.turns(), mirrored.turns);
+        CHECK_EQ(game.draws(), mirrored.wars);
+        CHECK_EQ(game.cardsTaken(0), mirrored.taken[0]);
+        CHECK_EQ(game.cardsTaken(1), mirrored.taken[1]);
+    }
+}
+
+TEST_CASE("Turn Stream") {
+    Player p1("Alice");
+    Player p2("Bob");
+    Player p3("Carol");
+    Player p4("Dave");
+    static_assert(std::ranges::input_range<Game::TurnStream>);
+    static_assert(std::ranges::view<Game::TurnStream>);
+    // only a forward range gets empty() and operator bool from
+    // view_interface, and those would have to look for a first turn.
+    static_assert(!std::ranges::forward_range<Game::TurnStream>);
+
+    SUBCASE("the stream plays the turns of playTurn()") {
+        for (std::uint64_t seed = 0; seed < 200; ++seed) {
+            Game stepped(p1, p2, seed);
+            Game streamed(p3, p4, seed);
+            std::uint32_t number = 0;
+            for (const Game::PlayedTurn &turn : streamed.turnStream()) {
+                const int taken = stepped.cardsTaken(0);
+                stepped.playTurn();
+                const std::vector<card> pot = stepped.lastPot();
+                CHECK_EQ(turn.number, ++number);
+                CHECK_EQ(turn.number, stepped.turns());
+                CHECK_EQ(turn.potSize, pot.size());
+                CHECK_EQ(streamed.draws(), stepped.draws());
+                CHECK_EQ(streamed.cardsTaken(0), stepped.cardsTaken(0));
+                const int firstShare = turn.winner <= 0 ? turn.potSize / 2 : 0;
+                CHECK_EQ(stepped.cardsTaken(0), taken + firstShare);
+                // the deciding pair is the last face up pair in the pot
+                const std::size_t pairs = turn.wars + (turn.winner >= 0 ? 1U : 0U);
+                const std::size_t last = turn::faceUpStride<ClassicRules>() * (pairs - 1);
+                CHECK_EQ(turn.faceUp[0], pot[last].packed());
+                CHECK_EQ(turn.faceUp[1], pot[last + 1].packed());
+            }
+            CHECK(streamed.finished());
+            CHECK(stepped.finished());
+            CHECK_EQ(streamed.turns(), stepped.turns());
+            CHECK_EQ(streamed.draws(), stepped.draws());
+            CHECK(streamed.warDepths() == stepped.warDepths());
+            const std::vector<card> streamedPot = streamed.lastPot();
+            const std::vector<card> steppedPot = stepped.lastPot();
+            CHECK(std::equal(streamedPot.begin(), streamedPot.end(), steppedPot.begin(), steppedPot.end(),
+                             [](const card &a, const card &b) { return a.packed() == b.packed(); }));
+        }
+    }
+
+    SUBCASE("turns record who took the pot and its wars") {
+        Game game(p1, p2, "23456789TJQKA23456789TJQKA" "23456789TJQKA23456789TJQKA");
+        int turns = 0;
+        for (const Game::PlayedTurn &turn : game.turnStream()) {
+            ++turns;
+            CHECK_EQ(turn.winner, -1);
+            CHECK_EQ(turn.wars, 13);
+            CHECK_EQ(turn.potSize, 52);
+            CHECK_EQ(turn.faceUp[0] / card::SUITS, turn.faceUp[1] / card::SUITS);
+        }
+        CHECK_EQ(turns, 1);
+
+        Game sorted(p3, p4, "22223333444455556666777788" "88999TTTTJJJJQQQQKKKKAAAA" "9");
+        for (const Game::PlayedTurn &turn : sorted.turnStream()) {
+            CHECK_EQ(turn.winner, 1);
+            CHECK_EQ(turn.wars, 0);
+            CHECK_EQ(turn.potSize, 2);
+        }
+        CHECK_EQ(sorted.winner(), &p4);
+    }
+
+    SUBCASE("stopping early leaves the rest unplayed") {
+        Game game(p1, p2, 7, LazyDeal{});
+        for (const Game::PlayedTurn &turn : game.turnStream()) {
+            if (turn.number == 5) {
+                break;
+            }
+        }
+        CHECK_EQ(game.turns(), 5);
+        CHECK_FALSE(game.finished());
+        // beginning a stream plays nothing until a turn is read
+        auto rest = game.turnStream();
+        auto next = rest.begin();
+        CHECK(next != std::default_sentinel);
+        CHECK_EQ(game.turns(), 5);
+        // a new stream picks up where the last one stopped
+        CHECK_EQ(next->number, 6);
+        CHECK_EQ(game.turns(), 6);
+        game.playAll();
+        CHECK(game.finished());
+        CHECK(game.turnStream().begin() == std::default_sentinel);
+    }
+
+    SUBCASE("reshuffling games stream until they end") {
+        ReshuffleGame game(p1, p2, 3);
+        game.setTurnCap(500);
+        std::uint32_t last = 0;
+        for (const ReshuffleGame::PlayedTurn &turn : game.turnStream()) {
+            last = turn.number;
+        }
+        CHECK(game.finished());
+        CHECK_EQ(last, static_cast<std::uint32_t>(game.turns()));
+        CHECK_NE(game.ending(), GameBase::Ending::Playing);
+    }
+}
+
+TEST_CASE("Game Observer") {
+    // every event, in fixed arrays: the hooks must not allocate.
+    struct Recorder : GameObserver {
+        std::array<unsigned, 64> warDepths{}; // onWarStart() depths of the current turn
+        unsigned warStarts = 0;
+        unsigned resolved = 0;
+        unsigned splits = 0;
+        unsigned turns = 0; // of the current game
+        unsigned totalTurns = 0;
+        unsigned potCards = 0;
+        unsigned ends = 0;
+        unsigned outOfOrder = 0;
+        GameBase::Ending ending = GameBase::Ending::Playing;
+
+        void onWarStart(unsigned depth, std::uint8_t first, std::uint8_t second) {
+            outOfOrder += depth != warStarts % 64 + 1 || first / card::SUITS != second / card::SUITS;
+            warDepths[warStarts++ % 64] = depth;
+        }
+        void onWarResolved(unsigned depth, int seat) {
+            outOfOrder += depth != warStarts || seat < 0;
+            ++resolved;
+        }
+        void onSplit(const GameBase::PlayedTurn &turn) {
+            outOfOrder += turn.winner != -1 || turn.wars != warStarts;
+            ++splits;
+        }
+        void onTurn(const GameBase::PlayedTurn &turn) {
+            if (turn.number == 1) { // a new game, after reset()
+                turns = 0;
+                potCards = 0;
+            }
+            outOfOrder += turn.number != ++turns || turn.wars != warStarts;
+            potCards += turn.potSize;
+            warStarts = 0;
+            ++totalTurns;
+        }
+        void onGameEnd(const GameBase &game, GameBase::Ending ended) {
+            // every card taken went through a pot.
+            outOfOrder += game.cardsTaken(0) + game.cardsTaken(1) > static_cast<int>(potCards) && turns != 0;
+            ending = ended;
+            ++ends;
+        }
+    };
+    // an observer that observes nothing costs no space.
+    struct Quiet : GameObserver {};
+    static_assert(sizeof(BasicGame<ClassicRules, Quiet>) == sizeof(Game));
+    // only the hooks an observer hides are called.
+    struct Ends : GameObserver {
+        void onGameEnd(const GameBase &, GameBase::Ending) {}
+    };
+    static_assert(!ObserverHooks<Quiet>::TURNS && !ObserverHooks<Quiet>::GAME_END);
+    static_assert(!ObserverHooks<Ends>::TURNS && ObserverHooks<Ends>::GAME_END);
+    static_assert(ObserverHooks<Recorder>::WAR_START && ObserverHooks<Recorder>::TURN);
+
+    Player p1("Alice");
+    Player p2("Bob");
+    Player p3("Carol");
+    Player p4("Dave");
+
+    SUBCASE("the hooks see every turn, war and end") {
+        for (std::uint64_t seed = 0; seed < 200; ++seed) {
+            BasicGame<ClassicRules, Recorder> observed(p1, p2, seed);
+            Game plain(p3, p4, seed);
+            observed.playAll();
+            plain.playAll();
+            const Recorder &seen = observed.observer();
+            CHECK_EQ(seen.outOfOrder, 0);
+            CHECK_EQ(seen.ends, 1);
+            CHECK_EQ(seen.turns, plain.turns());
+            CHECK_EQ(seen.ending, plain.ending());
+            CHECK_EQ(observed.draws(), plain.draws());
+            CHECK_EQ(observed.cardsTaken(0), plain.cardsTaken(0));
+        }
+    }
+
+    SUBCASE("splits and wars") {
+        BasicGame<ClassicRules, Recorder> mirrored(p1, p2, "23456789TJQKA23456789TJQKA" "23456789TJQKA23456789TJQKA");
+        mirrored.fastForward();
+        const Recorder &seen = mirrored.observer();
+        CHECK_EQ(seen.outOfOrder, 0);
+        CHECK_EQ(seen.turns, 1);
+        CHECK_EQ(seen.splits, 1);
+        CHECK_EQ(seen.resolved, 0);
+        CHECK_EQ(seen.warDepths[12], 13);
+        CHECK_EQ(seen.ending, GameBase::Ending::Draw);
+
+        // a war resolved on its second face up pair
+        BasicGame<ClassicRules, Recorder> war(p3, p4, "23A" "23445566778899TTJJQQKKA" "23K" "23445566778899TTJJQQKAA");
+        for (const GameBase::PlayedTurn &turn : war.turnStream()) {
+            CHECK_EQ(turn.winner, 0);
+            break;
+        }
+        CHECK_EQ(war.observer().resolved, 1);
+        CHECK_EQ(war.observer().totalTurns, 1);
+        CHECK_EQ(war.observer().ends, 0);
+        war.playAll();
+        CHECK_EQ(war.observer().ends, 1);
+    }
+
+    SUBCASE("a cache hit ends the game without turns") {
+        OutcomeCache cache(64);
+        BasicGame<ClassicRules, Recorder> first(p1, p2, 9);
+        first.playAll(cache);
+        BasicGame<ClassicRules, Recorder> second(p3, p4, 9);
+        second.playAll(cache);
+        CHECK_EQ(second.observer().turns, 0);
+        CHECK_EQ(second.observer().ends, 1);
+        CHECK_EQ(second.observer().ending, first.observer().ending);
+    }
+
+    SUBCASE("the observer is kept across reset()") {
+        BasicGame<ReshuffleRules, Recorder> game(p1, p2, 3);
+        game.setTurnCap(300);
+        game.playAll();
+        game.reset(p1, p2, 4);
+        game.playAll();
+        CHECK_EQ(game.observer().ends, 2);
+        CHECK_EQ(game.observer().outOfOrder, 0);
+        CHECK_NE(game.observer().ending, GameBase::Ending::Playing);
+    }
+
+    SUBCASE("observing allocates nothing") {
+        alloc::setTracking(true);
+        alloc::reset();
+        {
+            BasicGame<ClassicRules, Recorder> game(p1, p2, 11);
+            const auto log_allocations = alloc::counters(alloc::Component::GameLog).allocations;
+            const auto stats_allocations = alloc::counters(alloc::Component::Stats).allocations;
+            game.playAll();
+            CHECK_EQ(alloc::counters(alloc::Component::GameLog).allocations, log_allocations);
+            CHECK_EQ(alloc::counters(alloc::Component::Stats).allocations, stats_allocations);
+        }
+        alloc::setTracking(false);
+        alloc::reset();
+    }
+}
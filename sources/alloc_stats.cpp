@@ -0,0 +1,120 @@
+#include "alloc_stats.hpp"
+
+#include <iomanip>
+
+namespace ariel
+{
+    namespace alloc
+    {
+        namespace
+        {
+            struct AtomicCounters
+            {
+                std::atomic<std::uint64_t> allocations{0};
+                std::atomic<std::uint64_t> deallocations{0};
+                std::atomic<std::uint64_t> bytesAllocated{0};
+                std::atomic<std::uint64_t> bytesFreed{0};
+            };
+
+            std::array<AtomicCounters, COMPONENTS> &table()
+            {
+                static std::array<AtomicCounters, COMPONENTS> counters;
+                return counters;
+            }
+
+            AtomicCounters &at(Component component)
+            {
+                return table()[static_cast<std::size_t>(component)];
+            }
+        } // namespace
+
+        namespace detail
+        {
+            std::atomic<bool> enabled{false};
+            std::atomic<std::uint8_t> epoch{1};
+
+            void noteAllocate(Component component, std::size_t bytes)
+            {
+                AtomicCounters &entry = at(component);
+                entry.allocations.fetch_add(1, std::memory_order_relaxed);
+                entry.bytesAllocated.fetch_add(bytes, std::memory_order_relaxed);
+            }
+
+            void noteDeallocate(Component component, std::size_t bytes)
+            {
+                AtomicCounters &entry = at(component);
+                entry.deallocations.fetch_add(1, std::memory_order_relaxed);
+                entry.bytesFreed.fetch_add(bytes, std::memory_order_relaxed);
+            }
+        } // namespace detail
+
+        void setTracking(bool enabled)
+        {
+            detail::enabled.store(enabled, std::memory_order_relaxed);
+        }
+
+        bool tracking()
+        {
+            return detail::enabled.load(std::memory_order_relaxed);
+        }
+
+        Counters counters(Component component)
+        {
+            const AtomicCounters &entry = at(component);
+            Counters result;
+            result.allocations = entry.allocations.load(std::memory_order_relaxed);
+            result.deallocations = entry.deallocations.load(std::memory_order_relaxed);
+            result.bytesAllocated = entry.bytesAllocated.load(std::memory_order_relaxed);
+            result.bytesFreed = entry.bytesFreed.load(std::memory_order_relaxed);
+            return result;
+        }
+
+        void reset()
+        {
+            // the live blocks were counted before the reset, so their frees
+            // aren't counted after it. the epoch skips 0, which marks a block
+            // that wasn't counted; a block that outlives 255 resets is
+            // counted again.
+            const std::uint8_t next = static_cast<std::uint8_t>(detail::epoch.load(std::memory_order_relaxed) + 1);
+            detail::epoch.store(next == 0 ? 1 : next, std::memory_order_relaxed);
+            for (AtomicCounters &entry : table())
+            {
+                entry.allocations.store(0, std::memory_order_relaxed);
+                entry.deallocations.store(0, std::memory_order_relaxed);
+                entry.bytesAllocated.store(0, std::memory_order_relaxed);
+                entry.bytesFreed.store(0, std::memory_order_relaxed);
+            }
+        }
+
+        const char *name(Component component)
+        {
+            switch (component)
+            {
+            case Component::GameLog:
+                return "game log";
+            case Component::Name:
+                return "name strings";
+            case Component::Stats:
+                return "stats";
+            case Component::Cache:
+                return "outcome cache";
+            case Component::Count:
+                break;
+            }
+            return "?";
+        }
+
+        void print(std::ostream &out)
+        {
+            const int width = 14;
+            for (std::size_t i = 0; i < COMPONENTS; ++i)
+            {
+                const auto component = static_cast<Component>(i);
+                const Counters entry = counters(component);
+                out << "  " << std::left << std::setw(width) << name(component) << std::right
+                    << " allocations " << entry.allocations << ", frees " << entry.deallocations
+                    << ", bytes " << entry.bytesAllocated << ", live bytes " << entry.liveBytes() << '\n';
+            }
+        }
+    } // namespace alloc
+} // namespace ariel
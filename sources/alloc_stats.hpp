@@ -0,0 +1,159 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <new>
+#include <memory>
+#include <memory_resource>
+#include <ostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Heap allocation accounting per component of the game.
+//
+// Containers owned by Game and the name table allocate through
+// TrackedAllocator, which attributes every allocation to a Component and
+// forwards it to a std::pmr::memory_resource (the default resource unless
+// one is given).
+// Tracking is off by default and switched at runtime with
+// alloc::setTracking(); while it is off an allocation costs one relaxed
+// atomic load more than the resource itself. Every block starts with a
+// header of alignof(T) bytes, in front of the pointer handed out, whose
+// first byte records whether the allocation was counted, so a free is
+// counted exactly when its allocation was, whenever tracking is switched.
+// There is no lock and no table of blocks: the bookkeeping is the header.
+
+namespace ariel
+{
+    namespace alloc
+    {
+        enum class Component
+        {
+            GameLog,
+            Name,
+            Stats,
+            Cache,
+            Count
+        };
+
+        const std::size_t COMPONENTS = static_cast<std::size_t>(Component::Count);
+
+        struct Counters
+        {
+            std::uint64_t allocations = 0;
+            std::uint64_t deallocations = 0;
+            std::uint64_t bytesAllocated = 0;
+            std::uint64_t bytesFreed = 0;
+
+            std::uint64_t liveBytes() const { return bytesAllocated - bytesFreed; }
+        };
+
+        void setTracking(bool enabled);
+        bool tracking();
+
+        Counters counters(Component component);
+        void reset();
+
+        const char *name(Component component);
+
+        // one line per component.
+        void print(std::ostream &out);
+
+        namespace detail
+        {
+            extern std::atomic<bool> enabled;
+            // the counted blocks of reset() and before; their frees aren't
+            // counted. bumped by reset(), recorded in each counted header.
+            extern std::atomic<std::uint8_t> epoch;
+            void noteAllocate(Component component, std::size_t bytes);
+            void noteDeallocate(Component component, std::size_t bytes);
+        } // namespace detail
+
+        template <typename T, Component C>
+        class TrackedAllocator
+        {
+        public:
+            using value_type = T;
+
+            template <typename U>
+            struct rebind
+            {
+                using other = TrackedAllocator<U, C>;
+            };
+
+        private:
+            // the header in front of each block, keeping the block aligned.
+            // its first byte is 0 if the allocation wasn't counted, or else
+            // the epoch it was counted in.
+            static constexpr std::size_t HEADER = alignof(T);
+
+            std::pmr::memory_resource *resource_;
+
+        public:
+            TrackedAllocator() noexcept : resource_(std::pmr::get_default_resource()) {}
+            TrackedAllocator(std::pmr::memory_resource *resource) noexcept : resource_(resource) {}
+            template <typename U>
+            TrackedAllocator(const TrackedAllocator<U, C> &other) noexcept : resource_(other.resource())
+            {
+            }
+
+            std::pmr::memory_resource *resource() const noexcept { return resource_; }
+
+            T *allocate(std::size_t count)
+            {
+                if (count > (std::numeric_limits<std::size_t>::max() - HEADER) / sizeof(T))
+                {
+                    throw std::bad_array_new_length();
+                }
+                auto *header = static_cast<std::uint8_t *>(resource_->allocate(HEADER + count * sizeof(T), alignof(T)));
+                *header = 0;
+                if (detail::enabled.load(std::memory_order_relaxed))
+                {
+                    // 0 is never an epoch, see reset().
+                    *header = detail::epoch.load(std::memory_order_relaxed);
+                    detail::noteAllocate(C, count * sizeof(T));
+                }
+                return reinterpret_cast<T *>(header + HEADER);
+            }
+
+            void deallocate(T *ptr, std::size_t count) noexcept
+            {
+                std::uint8_t *header = reinterpret_cast<std::uint8_t *>(ptr) - HEADER;
+                if (*header != 0 && *header == detail::epoch.load(std::memory_order_relaxed))
+                {
+                    detail::noteDeallocate(C, count * sizeof(T));
+                }
+                resource_->deallocate(header, HEADER + count * sizeof(T), alignof(T));
+            }
+
+            // uses-allocator construction, so the strings inside a tracked
+            // vector allocate from the same resource as the vector itself.
+            template <typename U, typename... Args>
+            void construct(U *ptr, Args &&...args)
+            {
+                std::uninitialized_construct_using_allocator(ptr, *this, std::forward<Args>(args)...);
+            }
+
+            template <typename U>
+            bool operator==(const TrackedAllocator<U, C> &other) const noexcept
+            {
+                return resource_ == other.resource() || resource_->is_equal(*other.resource());
+            }
+            template <typename U>
+            bool operator!=(const TrackedAllocator<U, C> &other) const noexcept
+            {
+                return !(*this == other);
+            }
+        };
+
+        template <typename T, Component C>
+        using Vector = std::vector<T, TrackedAllocator<T, C>>;
+
+        template <Component C>
+        using String = std::basic_string<char, std::char_traits<char>, TrackedAllocator<char, C>>;
+    } // namespace alloc
+} // namespace ariel
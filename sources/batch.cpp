@@ -0,0 +1,270 @@
+#include "batch.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <exception>
+#include <memory_resource>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <thread>
+
+#include "game.hpp"
+#include "trace.hpp"
+
+namespace ariel
+{
+    void BatchStats::merge(const BatchStats &other)
+    {
+        games += other.games;
+        p1Wins += other.p1Wins;
+        p2Wins += other.p2Wins;
+        ties += other.ties;
+        cycles += other.cycles;
+        capped += other.capped;
+        stored += other.stored;
+        turns += other.turns;
+        draws += other.draws;
+        if (warDepths.size() < other.warDepths.size())
+        {
+            warDepths.resize(other.warDepths.size(), 0);
+        }
+        for (std::size_t depth = 0; depth < other.warDepths.size(); ++depth)
+        {
+            warDepths[depth] += other.warDepths[depth];
+        }
+    }
+
+    namespace
+    {
+        // plays game to its end and keeps what a batch counts of it.
+        template <typename Rules>
+        StoredResult playOut(const BatchOptions &options, BasicGame<Rules> &game, const Player &first)
+        {
+            if constexpr (Rules::RESHUFFLE)
+            {
+                game.setTurnCap(options.turnCap);
+            }
+            game.fastForward(); // only the counters are needed
+
+            StoredResult result;
+            result.ending = game.ending();
+            result.winner = game.winner() == nullptr ? 0 : (game.winner() == &first ? 1 : 2);
+            result.turns = static_cast<std::uint32_t>(game.turns());
+            result.draws = static_cast<std::uint32_t>(game.draws());
+            const auto &depths = game.warDepths();
+            result.depths = static_cast<std::uint8_t>(depths.size());
+            for (std::size_t depth = 0; depth < depths.size(); ++depth)
+            {
+                result.warDepths[depth] = static_cast<std::uint32_t>(depths[depth]);
+            }
+            return result;
+        }
+
+        template <typename Rules>
+        StoredResult play(const BatchOptions &options, std::uint64_t seed, Player &first, Player &second,
+                          std::pmr::memory_resource *resource)
+        {
+            if (options.corpus != nullptr)
+            {
+                std::array<std::uint8_t, card::DECK_SIZE> scratch;
+                BasicGame<Rules> game(first, second, options.corpus->deal(seed, scratch.data()), resource);
+                return playOut(options, game, first);
+            }
+            BasicGame<Rules> game(first, second, seed, resource);
+            return playOut(options, game, first);
+        }
+
+        void count(const StoredResult &result, BatchStats &stats)
+        {
+            switch (result.ending)
+            {
+            case GameBase::Ending::Cycle:
+                ++stats.cycles;
+                break;
+            case GameBase::Ending::Capped:
+                ++stats.capped;
+                break;
+            default:
+                if (result.winner == 0)
+                {
+                    ++stats.ties;
+                }
+                else if (result.winner == 1)
+                {
+                    ++stats.p1Wins;
+                }
+                else
+                {
+                    ++stats.p2Wins;
+                }
+                break;
+            }
+            ++stats.games;
+            stats.turns += result.turns;
+            stats.draws += result.draws;
+
+            if (stats.warDepths.size() < result.depths)
+            {
+                stats.warDepths.resize(result.depths, 0);
+            }
+            for (std::size_t depth = 0; depth < result.depths; ++depth)
+            {
+                stats.warDepths[depth] += result.warDepths[depth];
+            }
+        }
+
+        template <typename Rules>
+        void playBlock(const BatchOptions &options, std::uint64_t firstSeed, std::uint64_t games,
+                       std::pmr::memory_resource *resource, BatchStats &stats)
+        {
+            Player first("P1");
+            Player second("P2");
+
+            for (std::uint64_t seed = firstSeed; seed < firstSeed + games; ++seed)
+            {
+                if (options.store == nullptr)
+                {
+                    count(play<Rules>(options, seed, first, second, resource), stats);
+                }
+                else if (const std::optional<StoredResult> stored = options.store->find(options.variant, seed))
+                {
+                    count(*stored, stats);
+                    ++stats.stored;
+                }
+                else
+                {
+                    const StoredResult result = play<Rules>(options, seed, first, second, resource);
+                    options.store->insert(options.variant, seed, result);
+                    count(result, stats);
+                }
+            }
+        }
+
+        template <typename Rules>
+        void runWorker(const BatchOptions &options, std::uint64_t firstSeed, std::uint64_t games,
+                       BatchStats &stats)
+        {
+            ARIEL_TRACE_SCOPE("batch::worker");
+            if (options.arenaBytes == 0)
+            {
+                playBlock<Rules>(options, firstSeed, games, std::pmr::get_default_resource(), stats);
+                return;
+            }
+
+            std::vector<std::byte> buffer(options.arenaBytes);
+            std::pmr::monotonic_buffer_resource arena(buffer.data(), buffer.size(), std::pmr::new_delete_resource());
+            const std::uint64_t block = std::max<std::uint64_t>(1, options.gamesPerBlock);
+            for (std::uint64_t done = 0; done < games; done += block)
+            {
+                playBlock<Rules>(options, firstSeed + done, std::min(block, games - done), &arena, stats);
+                arena.release();
+            }
+        }
+
+        void runVariant(const BatchOptions &options, std::uint64_t firstSeed, std::uint64_t games,
+                        BatchStats &stats)
+        {
+            switch (options.variant)
+            {
+            case Variant::Classic:
+                runWorker<ClassicRules>(options, firstSeed, games, stats);
+                break;
+            case Variant::AceHigh:
+                runWorker<AceHighRules>(options, firstSeed, games, stats);
+                break;
+            case Variant::FaceDown2:
+                runWorker<FaceDownRules<2>>(options, firstSeed, games, stats);
+                break;
+            case Variant::FaceDown3:
+                runWorker<FaceDownRules<3>>(options, firstSeed, games, stats);
+                break;
+            case Variant::Reshuffle:
+                runWorker<ReshuffleRules>(options, firstSeed, games, stats);
+                break;
+            case Variant::Recycle:
+                runWorker<RecycleRules>(options, firstSeed, games, stats);
+                break;
+            }
+        }
+    } // namespace
+
+    BatchStats runBatch(const BatchOptions &options)
+    {
+        ARIEL_TRACE_SCOPE("batch::run");
+        if (options.corpus != nullptr &&
+            (options.store != nullptr || options.seed > options.corpus->size() ||
+             options.games > options.corpus->size() - options.seed))
+        {
+            throw std::invalid_argument("a corpus batch needs deals seed to seed + games in the corpus, and no store");
+        }
+        if (options.store != nullptr && options.store->turnCap() != options.turnCap)
+        {
+            throw std::invalid_argument("the store holds games of another turn cap");
+        }
+        const unsigned threads = std::max(1U, options.threads);
+        // each worker's stats on their own cache lines, so workers don't
+        // invalidate each other's lines on every game.
+        struct alignas(CACHE_LINE) WorkerStats
+        {
+            BatchStats stats;
+        };
+        std::vector<WorkerStats> partial(threads);
+        // what each worker threw, rethrown once all of them are joined: an
+        // exception leaving a thread's function would terminate.
+        std::vector<std::exception_ptr> failures(threads);
+        std::vector<std::thread> workers;
+        workers.reserve(threads);
+
+        std::uint64_t next = 0;
+        try
+        {
+            for (unsigned t = 0; t < threads; ++t)
+            {
+                // spread the remainder over the first workers.
+                const std::uint64_t share = options.games / threads + (t < options.games % threads ? 1 : 0);
+                workers.emplace_back([&options, &partial, &failures, t, next, share]() {
+                    try
+                    {
+                        trace::setThreadName("worker " + std::to_string(t));
+                        runVariant(options, options.seed + next, share, partial[t].stats);
+                    }
+                    catch (...)
+                    {
+                        failures[t] = std::current_exception();
+                    }
+                });
+                next += share;
+            }
+        }
+        catch (...)
+        {
+            // a thread couldn't be started; the ones that were still run.
+            for (std::thread &worker : workers)
+            {
+                worker.join();
+            }
+            throw;
+        }
+        for (std::thread &worker : workers)
+        {
+            worker.join();
+        }
+        for (const std::exception_ptr &failure : failures)
+        {
+            if (failure)
+            {
+                std::rethrow_exception(failure);
+            }
+        }
+
+        ARIEL_TRACE_SCOPE("batch::mergeStats");
+        BatchStats total;
+        for (const WorkerStats &worker : partial)
+        {
+            total.merge(worker.stats);
+        }
+        return total;
+    }
+}
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include "alloc_stats.hpp"
+#include "deal_corpus.hpp"
+#include "result_store.hpp"
+#include "rules.hpp"
+
+namespace ariel
+{
+    struct BatchOptions
+    {
+        std::uint64_t games = 0;
+        unsigned threads = 1;
+        std::uint64_t seed = 0; // game i is dealt with seed + i
+        Variant variant = Variant::Classic;
+        // reshuffling games that don't end are stopped after this many
+        // turns and counted as capped, so no worker is stuck on one game.
+        std::uint32_t turnCap = DEFAULT_TURN_CAP;
+        // seeds already in the store are counted from it instead of being
+        // played, and the games played are added to it. the store must be
+        // for turnCap (see ResultStore::turnCap()).
+        ResultStore *store = nullptr;
+        // game i is dealt deal seed + i of the corpus instead of a shuffled
+        // deck. the store is keyed by seed, so it can't be used with one.
+        const DealCorpus *corpus = nullptr;
+
+        // every worker allocates its games from a monotonic arena of this
+        // many bytes, released in one shot after each block of games.
+        // 0 allocates from the default resource instead.
+        std::size_t arenaBytes = std::size_t{4} << 20;
+        std::uint64_t gamesPerBlock = 256;
+    };
+
+    struct BatchStats
+    {
+        std::uint64_t games = 0;
+        std::uint64_t p1Wins = 0;
+        std::uint64_t p2Wins = 0;
+        std::uint64_t ties = 0;
+        std::uint64_t cycles = 0; // games stopped on a repeated position
+        std::uint64_t capped = 0; // games stopped at the turn cap
+        std::uint64_t stored = 0; // games taken from BatchOptions::store
+        std::uint64_t turns = 0;
+        std::uint64_t draws = 0;
+        alloc::Vector<std::uint64_t, alloc::Component::Stats> warDepths; // same meaning as Game::warDepths()
+
+        void merge(const BatchStats &other);
+    };
+
+    // plays options.games complete games split across options.threads workers.
+    // throws std::invalid_argument if options.corpus doesn't hold the games'
+    // deals or comes with a store, or if options.store is for another turn
+    // cap. whatever a worker throws is rethrown here once every worker has
+    // stopped (the first worker's, if several did).
+    BatchStats runBatch(const BatchOptions &options);
+}
@@ -0,0 +1,128 @@
+#include "canonical.hpp"
+
+#include <algorithm>
+
+namespace ariel
+{
+    namespace canonical
+    {
+        namespace
+        {
+            // n! for the copies of one rank.
+            constexpr std::array<std::uint64_t, card::SUITS + 1> FACTORIAL = {1, 1, 2, 6, 24};
+
+            constexpr std::uint64_t FULL_DECK = [] {
+                std::uint64_t product = 1;
+                for (int rank = 0; rank < RANKS; ++rank)
+                {
+                    product *= FACTORIAL[card::SUITS];
+                }
+                return product;
+            }();
+        }
+
+        std::uint64_t RankKey::hash() const
+        {
+            std::uint64_t hash = length;
+            for (std::uint64_t word : words)
+            {
+                hash = (hash ^ word) * 0x9e3779b97f4a7c15ULL;
+                hash ^= hash >> 29;
+            }
+            // splitmix64's finalizer
+            hash = (hash ^ (hash >> 30)) * 0xbf58476d1ce4e5b9ULL;
+            hash = (hash ^ (hash >> 27)) * 0x94d049bb133111ebULL;
+            return hash ^ (hash >> 31);
+        }
+
+        Canonical canonicalize(const std::uint8_t *deal, std::size_t count)
+        {
+            Canonical canonical;
+            canonical.key.length = static_cast<std::uint8_t>(count);
+            std::size_t first = 0;
+            for (std::uint64_t &word : canonical.key.words)
+            {
+                const std::size_t end = std::min(count, first + RankKey::PER_WORD);
+                if (end - first == RankKey::PER_WORD)
+                {
+                    // unrolled, so every shift is a constant.
+                    std::uint64_t ranks = 0;
+#pragma GCC unroll 16
+                    for (std::size_t i = 0; i < RankKey::PER_WORD; ++i)
+                    {
+                        ranks |= std::uint64_t{deal[first + i] / unsigned{card::SUITS}} << (4 * i);
+                    }
+                    word = ranks;
+                }
+                else
+                {
+                    for (std::size_t i = first; i < end; ++i)
+                    {
+                        word |= std::uint64_t{deal[i] / unsigned{card::SUITS}} << (4 * (i - first));
+                    }
+                }
+                first = end;
+            }
+
+            if (count == card::DECK_SIZE)
+            {
+                // the whole deck: every rank has all its suits.
+                canonical.multiplicity = FULL_DECK;
+                return canonical;
+            }
+            // copies of each rank, 4 bits each, so counting is an add in a
+            // register rather than a store and a load.
+            std::uint64_t copies = 0;
+            for (std::size_t i = 0; i < count; ++i)
+            {
+                copies += std::uint64_t{1} << (4 * (deal[i] / unsigned{card::SUITS}));
+            }
+            canonical.multiplicity = 1;
+            for (int rank = 0; rank < RANKS; ++rank)
+            {
+                canonical.multiplicity *= FACTORIAL[copies >> (4 * rank) & 15];
+            }
+            return canonical;
+        }
+
+        std::string rankString(const RankKey &key)
+        {
+            std::string ranks(key.length, ' ');
+            for (std::size_t i = 0; i < key.length; ++i)
+            {
+                ranks[i] = RANK_SYMBOLS[static_cast<std::size_t>(key.rank(i))];
+            }
+            return ranks;
+        }
+
+        std::optional<RankKey> parseRanks(std::string_view ranks)
+        {
+            if (ranks.size() > card::DECK_SIZE)
+            {
+                return std::nullopt;
+            }
+            RankKey key;
+            key.length = static_cast<std::uint8_t>(ranks.size());
+            for (std::size_t i = 0; i < ranks.size(); ++i)
+            {
+                const std::size_t rank = RANK_SYMBOLS.find(ranks[i]);
+                if (rank == std::string_view::npos)
+                {
+                    return std::nullopt;
+                }
+                key.words[i / RankKey::PER_WORD] |= std::uint64_t{rank} << (4 * (i % RankKey::PER_WORD));
+            }
+            return key;
+        }
+
+        void representative(const RankKey &key, std::uint8_t *deal)
+        {
+            std::array<std::uint8_t, RANKS> copies{};
+            for (std::size_t i = 0; i < key.length; ++i)
+            {
+                const auto rank = static_cast<std::size_t>(key.rank(i));
+                deal[i] = static_cast<std::uint8_t>(rank * card::SUITS + copies[rank]++);
+            }
+        }
+    } // namespace canonical
+} // namespace ariel
@@ -0,0 +1,72 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+
+#include "card.hpp"
+
+// Deals up to suits.
+//
+// No rule looks at a card's suit: turns compare ranks, and reshuffles move
+// cards without reading them. So two deals with the same ranks in the same
+// order play the same game, whatever suits the cards have; permuting the
+// suits, or swapping two cards of the same rank, changes nothing. A deal's
+// rank sequence is its canonical form, and the deals sharing it are counted
+// by its multiplicity.
+
+namespace ariel
+{
+    namespace canonical
+    {
+        const int RANKS = card::MAX_RANK - card::MIN_RANK + 1;
+        // how rank strings write each rank, from 2 to Ace.
+        constexpr std::string_view RANK_SYMBOLS = "23456789TJQKA";
+
+        // the rank of every card of a deal (card::rank() - 2, so 0..12), in
+        // deal order, 4 bits each: the first card in the low bits of
+        // words[0]. equal keys are equal rank sequences.
+        struct RankKey
+        {
+            static const std::size_t PER_WORD = 16;
+
+            std::array<std::uint64_t, (card::DECK_SIZE + PER_WORD - 1) / PER_WORD> words{};
+            std::uint8_t length = 0;
+
+            bool operator==(const RankKey &) const = default;
+
+            int rank(std::size_t i) const { return static_cast<int>(words[i / PER_WORD] >> (4 * (i % PER_WORD)) & 15); }
+            // 64 bits mixed from the whole key, for hash tables.
+            std::uint64_t hash() const;
+        };
+
+        struct Canonical
+        {
+            RankKey key;
+            // how many deals of these cards share the key: the product of
+            // count! over the ranks, e.g. 24^13 for a full deck.
+            std::uint64_t multiplicity = 0;
+        };
+
+        // the canonical form of the count distinct packed cards (see
+        // card::packed()) at deal, in the order they are dealt, so count is
+        // at most DECK_SIZE.
+        Canonical canonicalize(const std::uint8_t *deal, std::size_t count);
+
+        // the ranks of key as a rank string, e.g. "T2A" for a 10, a 2 and an
+        // Ace.
+        std::string rankString(const RankKey &key);
+
+        // the key of a rank string as rankString() writes it, or nothing if
+        // it has another character or more than DECK_SIZE ranks.
+        std::optional<RankKey> parseRanks(std::string_view ranks);
+
+        // the first deal with key, which must come from canonicalize(): the
+        // cards of each rank get their suits in the order of Suit. writes
+        // key.length packed cards to deal.
+        void representative(const RankKey &key, std::uint8_t *deal);
+    } // namespace canonical
+} // namespace ariel
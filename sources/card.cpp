@@ -0,0 +1,76 @@
+#include "card.hpp"
+
+namespace ariel
+{
+    namespace
+    {
+        const int ACE = 14;
+
+        // every card has its own name, made of its rank's and its suit's.
+        constexpr bool namesMatch()
+        {
+            for (std::size_t packed = 0; packed < card::DECK_SIZE; ++packed)
+            {
+                const card named = card::fromPacked(static_cast<std::uint8_t>(packed));
+                const std::string_view rank = cards::RANK_NAMES[static_cast<std::size_t>(named.rank() - card::MIN_RANK)];
+                const std::string_view suit = cards::SUIT_NAMES[static_cast<std::size_t>(named.suit())];
+                const std::string_view name = named.name();
+                if (name.size() != rank.size() + cards::OF.size() + suit.size() || !name.starts_with(rank) ||
+                    name.substr(rank.size(), cards::OF.size()) != cards::OF || !name.ends_with(suit) ||
+                    name.size() > cards::MAX_NAME)
+                {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        // ORDERED holds every card once, by suit then rank.
+        constexpr bool orderedDeck()
+        {
+            std::array<bool, card::DECK_SIZE> seen{};
+            for (std::size_t i = 0; i < card::DECK_SIZE; ++i)
+            {
+                const card next = cards::ORDERED[i];
+                if (seen[next.packed()] || cards::PACKED[next.packed()] != next.packed() ||
+                    (i > 0 && (next.suit() == cards::ORDERED[i - 1].suit()
+                                   ? next.rank() != cards::ORDERED[i - 1].rank() + 1
+                                   : next.rank() != card::MIN_RANK)))
+                {
+                    return false;
+                }
+                seen[next.packed()] = true;
+            }
+            return true;
+        }
+
+        static_assert(namesMatch(), "every card needs its name");
+        static_assert(orderedDeck(), "the ordered deck needs all 52 cards");
+        static_assert(cards::MAX_NAME == std::string_view("Queen of Diamonds").size());
+    } // namespace
+
+    int card::compare(const card &other) const
+    {
+        const int mine = rank();
+        const int theirs = other.rank();
+        if (mine == 2 && theirs == ACE)
+        {
+            return 1;
+        }
+        if (mine == ACE && theirs == 2)
+        {
+            return -1;
+        }
+        return mine - theirs;
+    }
+
+    std::string card::toString() const
+    {
+        return std::string(name());
+    }
+
+    std::vector<card> card::fullDeck()
+    {
+        return std::vector<card>(cards::ORDERED.begin(), cards::ORDERED.end());
+    }
+} // namespace ariel
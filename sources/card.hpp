@@ -1,13 +1,157 @@
 #pragma once
 
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
 namespace ariel
 {
+    enum class Suit : std::uint8_t
+    {
+        Hearts,
+        Diamonds,
+        Clubs,
+        Spades
+    };
+
+    // A card packs into one byte, (rank - 2) * 4 + suit, so a whole deck
+    // fits in a single cache line.
     class card
     {
     private:
+        std::uint8_t value_;
+
+        constexpr explicit card(std::uint8_t packed) : value_(packed) {}
+
     public:
-        card() {};
-        ~card() {};
+        static constexpr int MIN_RANK = 2;
+        static constexpr int MAX_RANK = 14;
+        static constexpr int DECK_SIZE = 52;
+        static constexpr int SUITS = 4;
+
+        constexpr card(int rank, Suit suit) : value_(0)
+        {
+            if (rank < MIN_RANK || rank > MAX_RANK)
+            {
+                throw std::invalid_argument("card rank must be between 2 and 14");
+            }
+            value_ = static_cast<std::uint8_t>((rank - MIN_RANK) * SUITS + static_cast<int>(suit));
+        }
+
+        // the inverse of packed(); value must be below DECK_SIZE.
+        static constexpr card fromPacked(std::uint8_t value) { return card(value); }
+        constexpr std::uint8_t packed() const { return value_; }
+
+        // 2..14, Jack = 11, Queen = 12, King = 13, Ace = 14
+        constexpr int rank() const { return value_ / SUITS + MIN_RANK; }
+        constexpr Suit suit() const { return static_cast<Suit>(value_ % SUITS); }
+
+        // positive if this card beats other, negative if other wins, 0 on a draw.
+        // higher rank wins, except that a 2 beats an Ace.
+        int compare(const card &other) const;
+
+        // e.g. "Queen of Hearts", "5 of Spades", from cards::NAMES.
+        constexpr std::string_view name() const;
+        std::string toString() const;
+
+        // all 52 cards, ordered by suit then rank, as cards::ORDERED.
+        static std::vector<card> fullDeck();
     };
-} // namespace ariel
 
+    // Tables of the whole deck, built at compile time.
+    namespace cards
+    {
+        constexpr std::array<std::string_view, card::MAX_RANK - card::MIN_RANK + 1> RANK_NAMES = {
+            "2", "3", "4", "5", "6", "7", "8", "9", "10", "Jack", "Queen", "King", "Ace"};
+        constexpr std::array<std::string_view, card::SUITS> SUIT_NAMES = {"Hearts", "Diamonds", "Clubs", "Spades"};
+        constexpr std::string_view OF = " of ";
+
+        // the name of every card, back to back in packed order, and where
+        // each one starts; the names are views of this one static buffer.
+        template <std::size_t Size>
+        struct NameBuffer
+        {
+            std::array<char, Size> chars{};
+            std::array<std::uint16_t, card::DECK_SIZE + 1> start{};
+        };
+
+        constexpr std::size_t nameBytes()
+        {
+            std::size_t bytes = 0;
+            for (std::size_t packed = 0; packed < card::DECK_SIZE; ++packed)
+            {
+                bytes += RANK_NAMES[packed / card::SUITS].size() + OF.size() + SUIT_NAMES[packed % card::SUITS].size();
+            }
+            return bytes;
+        }
+
+        constexpr NameBuffer<nameBytes()> NAME_BUFFER = [] {
+            NameBuffer<nameBytes()> buffer;
+            std::size_t at = 0;
+            for (std::size_t packed = 0; packed < card::DECK_SIZE; ++packed)
+            {
+                for (std::string_view part : {RANK_NAMES[packed / card::SUITS], OF, SUIT_NAMES[packed % card::SUITS]})
+                {
+                    for (char c : part)
+                    {
+                        buffer.chars[at++] = c;
+                    }
+                }
+                buffer.start[packed + 1] = static_cast<std::uint16_t>(at);
+            }
+            return buffer;
+        }();
+
+        // by packed value.
+        constexpr std::array<std::string_view, card::DECK_SIZE> NAMES = [] {
+            std::array<std::string_view, card::DECK_SIZE> names{};
+            for (std::size_t packed = 0; packed < card::DECK_SIZE; ++packed)
+            {
+                names[packed] = std::string_view(NAME_BUFFER.chars.data() + NAME_BUFFER.start[packed],
+                                                 NAME_BUFFER.start[packed + 1] - NAME_BUFFER.start[packed]);
+            }
+            return names;
+        }();
+
+        // the longest name, "Queen of Diamonds".
+        constexpr std::size_t MAX_NAME = [] {
+            std::size_t longest = 0;
+            for (std::string_view name : NAMES)
+            {
+                longest = std::max(longest, name.size());
+            }
+            return longest;
+        }();
+
+        // the packed values in order, the deck a shuffle starts from.
+        constexpr std::array<std::uint8_t, card::DECK_SIZE> PACKED = [] {
+            std::array<std::uint8_t, card::DECK_SIZE> deck{};
+            for (std::size_t packed = 0; packed < card::DECK_SIZE; ++packed)
+            {
+                deck[packed] = static_cast<std::uint8_t>(packed);
+            }
+            return deck;
+        }();
+
+        // every card ordered by suit then rank.
+        constexpr std::array<card, card::DECK_SIZE> ORDERED =
+            []<std::size_t... I>(std::index_sequence<I...>) {
+                const auto nth = [](std::size_t i) {
+                    return card(static_cast<int>(i) % (card::MAX_RANK - card::MIN_RANK + 1) + card::MIN_RANK,
+                                static_cast<Suit>(static_cast<int>(i) / (card::MAX_RANK - card::MIN_RANK + 1)));
+                };
+                return std::array<card, card::DECK_SIZE>{nth(I)...};
+            }(std::make_index_sequence<card::DECK_SIZE>{});
+    } // namespace cards
+
+    constexpr std::string_view card::name() const
+    {
+        return cards::NAMES[value_];
+    }
+} // namespace ariel
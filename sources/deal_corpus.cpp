@@ -0,0 +1,342 @@
+#include "deal_corpus.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "canonical.hpp"
+#include "dealer.hpp"
+#include "trace.hpp"
+#include "turn.hpp"
+
+namespace ariel
+{
+    namespace
+    {
+        struct alignas(64) Header
+        {
+            std::uint64_t magic;
+            std::uint32_t version;
+            std::uint32_t format;
+            std::uint64_t deals;
+            std::uint32_t dealBytes;
+            std::uint32_t property;
+            std::uint64_t perStratum; // 0 unless stratified
+        };
+        static_assert(sizeof(Header) == 64, "the deals start on a cache line");
+
+        const std::uint64_t MAGIC = 0x31534c4145445257ULL; // "WRDEALS1"
+        const std::uint32_t VERSION = 1;
+
+        const std::size_t HAND = card::DECK_SIZE / 2;
+        const std::uint8_t ACE = card::MAX_RANK - card::MIN_RANK;
+
+        [[noreturn]] void fail(const std::string &what, const std::string &path)
+        {
+            throw std::runtime_error("deal corpus " + path + ": " + what +
+                                     (errno != 0 ? std::string(" (") + std::strerror(errno) + ")" : ""));
+        }
+
+        std::size_t bytesPerDeal(DealCorpus::Format format)
+        {
+            return format == DealCorpus::Format::Cards ? DealCorpus::CARD_BYTES : DealCorpus::RANK_BYTES;
+        }
+
+        std::size_t stratumCount(CorpusProperty property)
+        {
+            switch (property)
+            {
+            case CorpusProperty::Aces:
+                return card::SUITS + 1;
+            case CorpusProperty::Wars:
+                return MAX_WARS + 1;
+            case CorpusProperty::None:
+                break;
+            }
+            return 1;
+        }
+
+        // whether the rank deal raw holds each rank below 13 exactly 4 times.
+        // canonical::representative() trusts this, a corrupt file would
+        // otherwise index out of bounds. a card deal needs no such check
+        // here: the game's span constructor refuses any that isn't a deck.
+        bool wholeRanks(const std::uint8_t *raw)
+        {
+            std::array<std::uint8_t, canonical::RANKS> copies{};
+            for (std::size_t i = 0; i < DealCorpus::RANK_BYTES; ++i)
+            {
+                for (const unsigned rank : {raw[i] & 15U, unsigned{raw[i]} >> 4})
+                {
+                    if (rank >= copies.size() || ++copies[rank] > card::SUITS)
+                    {
+                        return false;
+                    }
+                }
+            }
+            // 52 ranks, none more than 4 times: all 13 exactly 4 times.
+            return true;
+        }
+
+        // the draws of the game of deal, turn by turn as a Game plays it.
+        template <typename Rules>
+        unsigned draws(std::span<const std::uint8_t> deal)
+        {
+            return turn::playOut<Rules>(deal.data(), deal.data() + HAND, HAND).wars;
+        }
+
+        unsigned drawsUnder(Variant variant, std::span<const std::uint8_t> deal)
+        {
+            switch (variant)
+            {
+            case Variant::Classic:
+                return draws<ClassicRules>(deal);
+            case Variant::AceHigh:
+                return draws<AceHighRules>(deal);
+            case Variant::FaceDown2:
+                return draws<FaceDownRules<2>>(deal);
+            case Variant::FaceDown3:
+                return draws<FaceDownRules<3>>(deal);
+            case Variant::Reshuffle:
+            case Variant::Recycle:
+                break;
+            }
+            throw std::invalid_argument(std::string("can't stratify by the wars of ") +
+                                        std::string(variantName(variant)) + " games, they depend on more than the deal");
+        }
+    } // namespace
+
+    DealCorpus::DealCorpus(const std::string &path)
+    {
+        errno = 0;
+        fd_ = ::open(path.c_str(), O_RDONLY);
+        if (fd_ < 0)
+        {
+            fail("can't open", path);
+        }
+        try
+        {
+            struct stat status{};
+            if (::fstat(fd_, &status) != 0)
+            {
+                fail("can't stat", path);
+            }
+            bytes_ = static_cast<std::size_t>(status.st_size);
+            errno = 0;
+            if (bytes_ < sizeof(Header))
+            {
+                fail("not a deal corpus", path);
+            }
+            map_ = ::mmap(nullptr, bytes_, PROT_READ, MAP_SHARED, fd_, 0);
+            if (map_ == MAP_FAILED)
+            {
+                map_ = nullptr;
+                fail("can't map", path);
+            }
+            // batches and benchmarks read their deals in order.
+            ::madvise(map_, bytes_, MADV_SEQUENTIAL);
+
+            const Header &header = *static_cast<const Header *>(map_);
+            errno = 0;
+            if (header.magic != MAGIC || header.version != VERSION ||
+                header.format > static_cast<std::uint32_t>(Format::Ranks) ||
+                header.dealBytes != bytesPerDeal(static_cast<Format>(header.format)) ||
+                header.property > static_cast<std::uint32_t>(CorpusProperty::Wars) ||
+                header.deals > (bytes_ - sizeof(Header)) / header.dealBytes ||
+                bytes_ != sizeof(Header) + header.deals * header.dealBytes ||
+                (header.perStratum != 0 && header.deals % header.perStratum != 0))
+            {
+                fail("not a deal corpus", path);
+            }
+            format_ = static_cast<Format>(header.format);
+            property_ = static_cast<CorpusProperty>(header.property);
+            deals_ = static_cast<std::size_t>(header.deals);
+            dealBytes_ = header.dealBytes;
+            perStratum_ = static_cast<std::size_t>(header.perStratum);
+            deals0_ = static_cast<const std::uint8_t *>(map_) + sizeof(Header);
+        }
+        catch (...)
+        {
+            close();
+            throw;
+        }
+    }
+
+    DealCorpus::~DealCorpus()
+    {
+        close();
+    }
+
+    void DealCorpus::close()
+    {
+        if (map_ != nullptr)
+        {
+            ::munmap(map_, bytes_);
+            map_ = nullptr;
+        }
+        if (fd_ >= 0)
+        {
+            ::close(fd_);
+            fd_ = -1;
+        }
+    }
+
+    std::span<const std::uint8_t> DealCorpus::deal(std::size_t index, std::uint8_t *scratch) const
+    {
+        const std::uint8_t *raw = deals0_ + index * dealBytes_;
+        if (format_ == Format::Cards)
+        {
+            return {raw, CARD_BYTES};
+        }
+        if (!wholeRanks(raw))
+        {
+            throw std::runtime_error("deal corpus: deal " + std::to_string(index) + " isn't a whole deck");
+        }
+        // two ranks a byte is the layout of RankKey's words.
+        canonical::RankKey key;
+        key.length = card::DECK_SIZE;
+        for (std::size_t i = 0; i < RANK_BYTES; ++i)
+        {
+            key.words[i / 8] |= std::uint64_t{raw[i]} << (8 * (i % 8));
+        }
+        canonical::representative(key, scratch);
+        return {scratch, CARD_BYTES};
+    }
+
+    DealCorpusWriter::DealCorpusWriter(const std::string &path, DealCorpus::Format format, CorpusProperty property,
+                                       std::size_t perStratum)
+        : path_(path), out_(path, std::ios::binary | std::ios::trunc), format_(format), property_(property),
+          perStratum_(perStratum)
+    {
+        // the header is written again with the count by close().
+        const Header header{};
+        out_.write(reinterpret_cast<const char *>(&header), sizeof(header));
+        if (!out_)
+        {
+            errno = 0;
+            fail("can't create", path_);
+        }
+    }
+
+    DealCorpusWriter::~DealCorpusWriter()
+    {
+        try
+        {
+            close();
+        }
+        catch (const std::runtime_error &)
+        {
+            // nothing to tell from here; close() first to see errors.
+        }
+    }
+
+    void DealCorpusWriter::append(std::span<const std::uint8_t> deal)
+    {
+        if (deal.size() != card::DECK_SIZE)
+        {
+            throw std::invalid_argument("a corpus deal needs 52 cards");
+        }
+        if (format_ == DealCorpus::Format::Cards)
+        {
+            out_.write(reinterpret_cast<const char *>(deal.data()), DealCorpus::CARD_BYTES);
+        }
+        else
+        {
+            std::array<char, DealCorpus::RANK_BYTES> ranks;
+            for (std::size_t i = 0; i < ranks.size(); ++i)
+            {
+                ranks[i] = static_cast<char>(deal[2 * i] / card::SUITS | deal[2 * i + 1] / card::SUITS << 4);
+            }
+            out_.write(ranks.data(), ranks.size());
+        }
+        ++deals_;
+    }
+
+    void DealCorpusWriter::close()
+    {
+        if (!out_.is_open())
+        {
+            return;
+        }
+        const Header header{MAGIC,
+                            VERSION,
+                            static_cast<std::uint32_t>(format_),
+                            deals_,
+                            static_cast<std::uint32_t>(bytesPerDeal(format_)),
+                            static_cast<std::uint32_t>(property_),
+                            perStratum_};
+        out_.seekp(0);
+        out_.write(reinterpret_cast<const char *>(&header), sizeof(header));
+        out_.close();
+        errno = 0;
+        if (!out_)
+        {
+            fail("can't write", path_);
+        }
+        if (perStratum_ != 0 && deals_ % perStratum_ != 0)
+        {
+            fail("a stratum isn't full", path_);
+        }
+    }
+
+    std::size_t stratumOf(std::span<const std::uint8_t> deal, CorpusProperty property, Variant variant)
+    {
+        switch (property)
+        {
+        case CorpusProperty::Aces:
+            return static_cast<std::size_t>(std::count_if(deal.begin(), deal.begin() + HAND, [](std::uint8_t packed) {
+                return packed / card::SUITS == ACE;
+            }));
+        case CorpusProperty::Wars:
+            return std::min(drawsUnder(variant, deal), MAX_WARS);
+        case CorpusProperty::None:
+            break;
+        }
+        return 0;
+    }
+
+    std::uint64_t writeCorpus(const std::string &path, const CorpusOptions &options)
+    {
+        ARIEL_TRACE_SCOPE("corpus::write");
+        const std::size_t strata = stratumCount(options.property);
+        // the strata fill at different rates, so the deals are kept until
+        // all of them are full and then written stratum by stratum.
+        std::vector<std::vector<std::uint8_t>> chosen(strata);
+        std::size_t full = 0;
+        std::uint64_t candidates = 0;
+        for (std::uint64_t seed = options.seed; full < strata && options.perStratum != 0; ++seed)
+        {
+            if (candidates == options.maxCandidates)
+            {
+                errno = 0;
+                fail("no full strata after " + std::to_string(candidates) + " candidates", path);
+            }
+            ++candidates;
+            const auto deck = shuffledDeck(seed);
+            std::vector<std::uint8_t> &stratum = chosen[stratumOf(deck, options.property, options.variant)];
+            if (stratum.size() < options.perStratum * card::DECK_SIZE)
+            {
+                stratum.insert(stratum.end(), deck.begin(), deck.end());
+                full += stratum.size() == options.perStratum * card::DECK_SIZE;
+            }
+        }
+
+        const bool stratified = options.property != CorpusProperty::None;
+        DealCorpusWriter writer(path, options.format, options.property, stratified ? options.perStratum : 0);
+        for (const std::vector<std::uint8_t> &stratum : chosen)
+        {
+            for (std::size_t first = 0; first < stratum.size(); first += card::DECK_SIZE)
+            {
+                writer.append(std::span<const std::uint8_t>(stratum).subspan(first, card::DECK_SIZE));
+            }
+        }
+        writer.close();
+        return candidates;
+    }
+} // namespace ariel
@@ -0,0 +1,170 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "card.hpp"
+#include "rules.hpp"
+
+namespace ariel
+{
+    // What a stratified corpus groups its deals by.
+    enum class CorpusProperty : std::uint32_t
+    {
+        None,
+        Aces, // aces in the first player's hand, 0 to 4
+        Wars  // draws in the game of the deal, 0 to MAX_WARS or more
+    };
+
+    constexpr std::array<std::string_view, 3> PROPERTY_NAMES = {"none", "aces", "wars"};
+
+    constexpr std::string_view propertyName(CorpusProperty property)
+    {
+        return PROPERTY_NAMES[static_cast<std::size_t>(property)];
+    }
+
+    // the property called name, if there is one.
+    constexpr std::optional<CorpusProperty> parseProperty(std::string_view name)
+    {
+        for (std::size_t i = 0; i < PROPERTY_NAMES.size(); ++i)
+        {
+            if (PROPERTY_NAMES[i] == name)
+            {
+                return static_cast<CorpusProperty>(i);
+            }
+        }
+        return std::nullopt;
+    }
+
+    // Predetermined deals in a memory mapped file, for benchmarks and batches
+    // that replay the same games from run to run.
+    //
+    // The file is a 64 byte header followed by the deals back to back, each
+    // either the 52 packed cards in deal order (see card::packed()) or, for
+    // Format::Ranks, their 52 ranks 4 bits each, the first card in the low
+    // bits of the first byte. Only the ranks decide a game (see
+    // canonical.hpp), so a rank deal plays as its cards do. Opening the file
+    // maps it and checks only the header, so it touches no deal; deals are
+    // read in place, nothing is parsed or copied, and each is checked to be
+    // a whole deck as it's read.
+    //
+    // A stratified corpus holds perStratum() deals of each value of its
+    // property, in order: the deals of stratum k are [k * perStratum(),
+    // (k + 1) * perStratum()).
+    //
+    // The file is in the byte order of the machine that wrote it.
+    class DealCorpus
+    {
+    public:
+        enum class Format : std::uint32_t
+        {
+            Cards,
+            Ranks
+        };
+
+        // bytes per deal in each format.
+        static const std::size_t CARD_BYTES = card::DECK_SIZE;
+        static const std::size_t RANK_BYTES = card::DECK_SIZE / 2;
+
+        // throws std::runtime_error if the file can't be opened or mapped or
+        // isn't a deal corpus.
+        explicit DealCorpus(const std::string &path);
+        ~DealCorpus();
+
+        DealCorpus(const DealCorpus &) = delete;
+        DealCorpus &operator=(const DealCorpus &) = delete;
+
+        std::size_t size() const { return deals_; }
+        Format format() const { return format_; }
+        CorpusProperty property() const { return property_; }
+        std::size_t perStratum() const { return perStratum_; }
+        std::size_t strata() const { return perStratum_ == 0 ? 0 : deals_ / perStratum_; }
+
+        // the index-th deal as 52 packed cards, for index < size(): a view of
+        // the mapped file itself for Format::Cards, or scratch, which then
+        // needs room for 52 cards, filled with the first deal of the ranks
+        // (see canonical::representative()). the view is only valid while the
+        // corpus is open. throws std::runtime_error if a rank deal isn't a
+        // whole deck; a card deal that isn't is returned as it is, and the
+        // game it's dealt to throws std::invalid_argument.
+        std::span<const std::uint8_t> deal(std::size_t index, std::uint8_t *scratch) const;
+
+    private:
+        int fd_ = -1;
+        void *map_ = nullptr;
+        std::size_t bytes_ = 0;
+        const std::uint8_t *deals0_ = nullptr;
+        std::size_t deals_ = 0;
+        std::size_t dealBytes_ = 0;
+        Format format_ = Format::Cards;
+        CorpusProperty property_ = CorpusProperty::None;
+        std::size_t perStratum_ = 0;
+
+        void close();
+    };
+
+    // Writes a DealCorpus one deal at a time; the header is completed by
+    // close(), or by the destructor, which ignores errors.
+    class DealCorpusWriter
+    {
+    public:
+        // throws std::runtime_error if the file can't be created.
+        DealCorpusWriter(const std::string &path, DealCorpus::Format format,
+                         CorpusProperty property = CorpusProperty::None, std::size_t perStratum = 0);
+        ~DealCorpusWriter();
+
+        DealCorpusWriter(const DealCorpusWriter &) = delete;
+        DealCorpusWriter &operator=(const DealCorpusWriter &) = delete;
+
+        // throws std::invalid_argument unless deal holds 52 cards.
+        void append(std::span<const std::uint8_t> deal);
+        std::size_t size() const { return deals_; }
+        // throws std::runtime_error if the file can't be written; also if a
+        // stratified corpus doesn't hold whole strata.
+        void close();
+
+    private:
+        std::string path_;
+        std::ofstream out_;
+        DealCorpus::Format format_;
+        CorpusProperty property_;
+        std::size_t perStratum_;
+        std::size_t deals_ = 0;
+    };
+
+    struct CorpusOptions
+    {
+        DealCorpus::Format format = DealCorpus::Format::Cards;
+        CorpusProperty property = CorpusProperty::Aces;
+        std::size_t perStratum = 1000;
+        // candidates are the deals of seed, seed + 1, ... as a seeded Game
+        // shuffles them, in order, until every stratum is full.
+        std::uint64_t seed = 0;
+        // the rules whose wars CorpusProperty::Wars counts; one without
+        // reshuffling, so the wars only depend on the deal.
+        Variant variant = Variant::Classic;
+        // gives up with std::runtime_error after this many candidates.
+        std::uint64_t maxCandidates = std::uint64_t{1} << 32;
+    };
+
+    // CorpusProperty::Wars puts every deal with more draws in the last
+    // stratum.
+    const unsigned MAX_WARS = 5;
+
+    // the stratum of deal for property, 0 for CorpusProperty::None. throws
+    // std::invalid_argument for CorpusProperty::Wars under reshuffling
+    // rules.
+    std::size_t stratumOf(std::span<const std::uint8_t> deal, CorpusProperty property, Variant variant);
+
+    // writes options.perStratum deals of each stratum to a corpus at path,
+    // or just the deals of the first options.perStratum seeds for
+    // CorpusProperty::None. returns the candidates drawn.
+    std::uint64_t writeCorpus(const std::string &path, const CorpusOptions &options);
+} // namespace ariel
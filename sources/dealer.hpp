@@ -0,0 +1,105 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <random>
+
+#include "card.hpp"
+
+// Dealing a deck from a seed: shuffledDeck() all at once, as a seeded Game
+// deals, and Dealer one card at a time, for lazy deals (see LazyDeal in
+// game.hpp). Everything but shuffledDeck() is constexpr, so a seeded lazy
+// deal can be played at compile time (see turn::playOut()).
+
+namespace ariel
+{
+    // the next splitmix64 value from state.
+    constexpr std::uint64_t splitMix64(std::uint64_t &state)
+    {
+        std::uint64_t value = (state += 0x9e3779b97f4a7c15ULL);
+        value = (value ^ (value >> 30)) * 0xbf58476d1ce4e5b9ULL;
+        value = (value ^ (value >> 27)) * 0x94d049bb133111ebULL;
+        return value ^ (value >> 31);
+    }
+
+    // a uniform value below bound, which must be positive, from splitmix64:
+    // Lemire's multiply and shift, redrawing the few products that would
+    // make some values likelier than others.
+    constexpr std::uint64_t uniformBelow(std::uint64_t &state, std::uint64_t bound)
+    {
+        using Wide = unsigned __int128;
+        Wide product = Wide{splitMix64(state)} * bound;
+        if (static_cast<std::uint64_t>(product) < bound)
+        {
+            const std::uint64_t threshold = (0 - bound) % bound;
+            while (static_cast<std::uint64_t>(product) < threshold)
+            {
+                product = Wide{splitMix64(state)} * bound;
+            }
+        }
+        return static_cast<std::uint64_t>(product >> 64);
+    }
+
+    // the deck a seeded Game deals: the packed cards through std::shuffle
+    // with a std::mt19937_64. mt19937_64 is the same everywhere, but how
+    // std::shuffle draws from it is up to the standard library, so the deal
+    // of a seed is only the same with the same library (see ResultStore).
+    inline std::array<std::uint8_t, card::DECK_SIZE> shuffledDeck(std::uint64_t seed)
+    {
+        std::array<std::uint8_t, card::DECK_SIZE> deck = cards::PACKED;
+        std::mt19937_64 rng(seed);
+        std::shuffle(deck.begin(), deck.end(), rng);
+        return deck;
+    }
+
+    // A deal made as the cards are played: the cards not dealt yet and the
+    // splitmix64 state that picks them. Position k of both hands is dealt
+    // before position k + 1, each card a uniform pick swapped out of those
+    // left (Fisher-Yates one card at a time), so every order of the deck is
+    // as likely as after a full shuffle up front.
+    struct Dealer
+    {
+        static constexpr unsigned HAND = card::DECK_SIZE / 2;
+
+        std::array<std::uint8_t, card::DECK_SIZE> left{}; // left[0, count)
+        std::uint8_t count = 0;
+        std::uint8_t dealt = HAND; // positions of each hand dealt
+        std::uint64_t state = 0;
+
+        static constexpr Dealer start(std::uint64_t seed)
+        {
+            Dealer dealer;
+            dealer.left = cards::PACKED;
+            dealer.count = card::DECK_SIZE;
+            dealer.dealt = 0;
+            dealer.state = seed;
+            return dealer;
+        }
+
+        // deals positions [dealt, upTo) of both hands to deck, p1's hand
+        // first, as BasicGame holds them.
+        constexpr void dealTo(std::array<std::uint8_t, card::DECK_SIZE> &deck, unsigned upTo)
+        {
+            for (; dealt < upTo; ++dealt)
+            {
+                for (unsigned seat = 0; seat < 2; ++seat)
+                {
+                    const auto picked = static_cast<std::size_t>(uniformBelow(state, count));
+                    --count;
+                    deck[seat * HAND + dealt] = left[picked];
+                    left[picked] = left[count];
+                }
+            }
+        }
+    };
+
+    // the whole deck of a lazy deal from seed.
+    constexpr std::array<std::uint8_t, card::DECK_SIZE> lazyDeck(std::uint64_t seed)
+    {
+        std::array<std::uint8_t, card::DECK_SIZE> deck{};
+        Dealer dealer = Dealer::start(seed);
+        dealer.dealTo(deck, Dealer::HAND);
+        return deck;
+    }
+} // namespace ariel
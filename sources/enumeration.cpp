@@ -0,0 +1,248 @@
+#include "enumeration.hpp"
+
+#include <algorithm>
+#include <array>
+#include <exception>
+#include <limits>
+#include <numeric>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <utility>
+
+#include "game.hpp"
+#include "trace.hpp"
+#include "turn.hpp"
+
+namespace ariel
+{
+    namespace
+    {
+        using Wide = unsigned __int128;
+
+        const Wide MAX_DEALS = std::numeric_limits<std::uint64_t>::max();
+
+        // one game of a deal without reshuffling, on packed cards whose
+        // suits don't matter.
+        template <typename Rules>
+        DealOutcome playDeal(const std::uint8_t *cards, unsigned count)
+        {
+            const unsigned hand = count / 2;
+            const turn::Tally tally = turn::playOut<Rules>(cards, cards + hand, hand);
+            return {static_cast<std::uint8_t>(tally.winner()), static_cast<std::uint8_t>(tally.turns),
+                    static_cast<std::uint8_t>(tally.wars)};
+        }
+
+        template <typename Rules>
+        void enumerateRange(const ReducedDeck &deck, std::uint64_t begin, std::uint64_t end, Enumeration &tally,
+                            DealOutcome *table)
+        {
+            ARIEL_TRACE_SCOPE("enumerate::worker");
+            const auto count = static_cast<unsigned>(deck.cards());
+            std::array<std::uint8_t, card::DECK_SIZE> cards{};
+            const canonical::RankKey first = deck.deal(begin);
+            for (unsigned i = 0; i < count; ++i)
+            {
+                cards[i] = static_cast<std::uint8_t>(first.rank(i) * card::SUITS);
+            }
+
+            for (std::uint64_t index = begin; index < end; ++index)
+            {
+                const DealOutcome outcome = playDeal<Rules>(cards.data(), count);
+                tally.p1Wins += outcome.winner == 1;
+                tally.p2Wins += outcome.winner == 2;
+                tally.ties += outcome.winner == 0;
+                tally.turns += outcome.turns;
+                tally.draws += outcome.draws;
+                if (table != nullptr)
+                {
+                    table[index] = outcome;
+                }
+                // the cards all have suit 0, so this is the next order of
+                // the ranks.
+                std::next_permutation(cards.begin(), cards.begin() + count);
+            }
+        }
+
+        void enumerateVariant(const ReducedDeck &deck, Variant variant, std::uint64_t begin, std::uint64_t end,
+                              Enumeration &tally, DealOutcome *table)
+        {
+            switch (variant)
+            {
+            case Variant::Classic:
+                enumerateRange<ClassicRules>(deck, begin, end, tally, table);
+                break;
+            case Variant::AceHigh:
+                enumerateRange<AceHighRules>(deck, begin, end, tally, table);
+                break;
+            case Variant::FaceDown2:
+                enumerateRange<FaceDownRules<2>>(deck, begin, end, tally, table);
+                break;
+            case Variant::FaceDown3:
+                enumerateRange<FaceDownRules<3>>(deck, begin, end, tally, table);
+                break;
+            case Variant::Reshuffle:
+            case Variant::Recycle:
+                break;
+            }
+        }
+    } // namespace
+
+    ReducedDeck::ReducedDeck(std::vector<int> ranks, int suits) : ranks_(std::move(ranks))
+    {
+        std::sort(ranks_.begin(), ranks_.end());
+        if (suits < 1 || suits > card::SUITS || ranks_.empty() ||
+            std::adjacent_find(ranks_.begin(), ranks_.end()) != ranks_.end() || ranks_.front() < card::MIN_RANK ||
+            ranks_.back() > card::MAX_RANK || ranks_.size() * static_cast<std::size_t>(suits) % 2 != 0)
+        {
+            throw std::invalid_argument("a reduced deck needs distinct ranks from 2 to 14, 1 to 4 suits and an "
+                                        "even number of cards");
+        }
+        suits_ = static_cast<std::size_t>(suits);
+        for (int &rank : ranks_)
+        {
+            rank -= card::MIN_RANK;
+        }
+
+        // the multinomial cards()! / (suits!)^ranks, one card at a time:
+        // adding the k-th copy of a rank to n - 1 cards multiplies the
+        // orders by n / k, exactly.
+        Wide deals = 1;
+        unsigned placed = 0;
+        for (std::size_t rank = 0; rank < ranks_.size(); ++rank)
+        {
+            for (unsigned copy = 1; copy <= suits_; ++copy)
+            {
+                ++placed;
+                deals = deals * placed / copy;
+                if (deals > MAX_DEALS)
+                {
+                    throw std::overflow_error("a reduced deck of " + std::to_string(cards()) +
+                                              " cards has too many deals to count");
+                }
+                multiplicity_ *= copy;
+            }
+        }
+        deals_ = static_cast<std::uint64_t>(deals);
+    }
+
+    canonical::RankKey ReducedDeck::deal(std::uint64_t index) const
+    {
+        // at each position, the orders starting with a rank are the orders
+        // of the rest, deals * copies / cards; skip whole blocks of them.
+        std::vector<std::size_t> copies(ranks_.size(), suits_);
+        Wide orders = deals_;
+        canonical::RankKey key;
+        key.length = static_cast<std::uint8_t>(cards());
+        for (std::size_t i = 0, left = cards(); i < cards(); ++i, --left)
+        {
+            for (std::size_t rank = 0; rank < ranks_.size(); ++rank)
+            {
+                if (copies[rank] == 0)
+                {
+                    continue;
+                }
+                const Wide starting = orders * copies[rank] / left;
+                if (index < starting)
+                {
+                    key.words[i / canonical::RankKey::PER_WORD] |=
+                        static_cast<std::uint64_t>(ranks_[rank]) << (4 * (i % canonical::RankKey::PER_WORD));
+                    --copies[rank];
+                    orders = starting;
+                    break;
+                }
+                index -= static_cast<std::uint64_t>(starting);
+            }
+        }
+        return key;
+    }
+
+    Fraction Enumeration::probability(std::uint64_t count) const
+    {
+        const std::uint64_t divisor = std::gcd(count, deals);
+        return divisor == 0 ? Fraction{} : Fraction{count / divisor, deals / divisor};
+    }
+
+    Enumeration enumerate(const ReducedDeck &deck, const EnumerationOptions &options)
+    {
+        ARIEL_TRACE_SCOPE("enumerate::run");
+        if (options.variant == Variant::Reshuffle || options.variant == Variant::Recycle)
+        {
+            throw std::invalid_argument(std::string("can't enumerate ") + std::string(variantName(options.variant)) +
+                                        " games, they depend on more than the deal");
+        }
+
+        Enumeration total;
+        total.deals = deck.deals();
+        total.multiplicity = deck.multiplicity();
+        if (options.table)
+        {
+            total.table.resize(static_cast<std::size_t>(deck.deals()));
+        }
+        DealOutcome *table = options.table ? total.table.data() : nullptr;
+
+        const unsigned threads = std::max(1U, options.threads);
+        struct alignas(CACHE_LINE) WorkerTally
+        {
+            Enumeration tally;
+        };
+        std::vector<WorkerTally> partial(threads);
+        // what each worker threw, rethrown once all of them are joined: an
+        // exception leaving a thread's function would terminate.
+        std::vector<std::exception_ptr> failures(threads);
+        std::vector<std::thread> workers;
+        workers.reserve(threads);
+        try
+        {
+            for (unsigned t = 0; t < threads; ++t)
+            {
+                const auto begin = static_cast<std::uint64_t>(Wide{deck.deals()} * t / threads);
+                const auto end = static_cast<std::uint64_t>(Wide{deck.deals()} * (t + 1) / threads);
+                workers.emplace_back([&deck, &options, &partial, &failures, table, t, begin, end]() {
+                    try
+                    {
+                        trace::setThreadName("worker " + std::to_string(t));
+                        if (begin < end)
+                        {
+                            enumerateVariant(deck, options.variant, begin, end, partial[t].tally, table);
+                        }
+                    }
+                    catch (...)
+                    {
+                        failures[t] = std::current_exception();
+                    }
+                });
+            }
+        }
+        catch (...)
+        {
+            // a thread couldn't be started; the ones that were still run.
+            for (std::thread &worker : workers)
+            {
+                worker.join();
+            }
+            throw;
+        }
+        for (std::thread &worker : workers)
+        {
+            worker.join();
+        }
+        for (const std::exception_ptr &failure : failures)
+        {
+            if (failure)
+            {
+                std::rethrow_exception(failure);
+            }
+        }
+
+        for (const WorkerTally &worker : partial)
+        {
+            total.p1Wins += worker.tally.p1Wins;
+            total.p2Wins += worker.tally.p2Wins;
+            total.ties += worker.tally.ties;
+            total.turns += worker.tally.turns;
+            total.draws += worker.tally.draws;
+        }
+        return total;
+    }
+} // namespace ariel
@@ -0,0 +1,95 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "alloc_stats.hpp"
+#include "canonical.hpp"
+#include "rules.hpp"
+
+namespace ariel
+{
+    // A deck of suits cards of each of the given ranks, e.g. Jack, Queen and
+    // King in 4 suits, dealt half to each player.
+    //
+    // Only the ranks decide a game (see canonical.hpp), so its deals are
+    // enumerated up to suits: every distinct order of the ranks, in
+    // lexicographic order, each standing for multiplicity() deals of the
+    // actual cards.
+    class ReducedDeck
+    {
+    public:
+        // throws std::invalid_argument unless the ranks are distinct, 2 to
+        // 14, with 1 to 4 suits and an even number of cards, at least 2;
+        // throws std::overflow_error if the deals don't fit 64 bits.
+        ReducedDeck(std::vector<int> ranks, int suits);
+
+        std::size_t cards() const { return ranks_.size() * suits_; }
+        // orders of the ranks: cards()! / (suits!)^ranks.
+        std::uint64_t deals() const { return deals_; }
+        // deals of the cards per order of the ranks: (suits!)^ranks.
+        std::uint64_t multiplicity() const { return multiplicity_; }
+
+        // the index-th order of the ranks, for index < deals(). any worker
+        // can start anywhere and go on with std::next_permutation().
+        canonical::RankKey deal(std::uint64_t index) const;
+
+    private:
+        std::vector<int> ranks_; // card::rank() - 2, ascending
+        std::size_t suits_;
+        std::uint64_t deals_ = 0;
+        std::uint64_t multiplicity_ = 1;
+    };
+
+    // a fraction in lowest terms.
+    struct Fraction
+    {
+        std::uint64_t numerator = 0;
+        std::uint64_t denominator = 1;
+
+        double value() const { return static_cast<double>(numerator) / static_cast<double>(denominator); }
+        bool operator==(const Fraction &) const = default;
+    };
+
+    struct DealOutcome
+    {
+        std::uint8_t winner = 0; // 1 + the winner's seat, 0 on a tie
+        std::uint8_t turns = 0;
+        std::uint8_t draws = 0;
+
+        bool operator==(const DealOutcome &) const = default;
+    };
+
+    struct EnumerationOptions
+    {
+        Variant variant = Variant::Classic; // one without reshuffling
+        unsigned threads = 1;
+        bool table = false; // keep the outcome of every deal
+    };
+
+    struct Enumeration
+    {
+        std::uint64_t deals = 0; // orders of the ranks, see ReducedDeck
+        std::uint64_t multiplicity = 1;
+        std::uint64_t p1Wins = 0;
+        std::uint64_t p2Wins = 0;
+        std::uint64_t ties = 0;
+        std::uint64_t turns = 0;
+        std::uint64_t draws = 0;
+        // by deal index, when EnumerationOptions::table is set.
+        alloc::Vector<DealOutcome, alloc::Component::Stats> table;
+
+        // count out of deals. every order of the ranks stands for as many
+        // deals of the cards, so this is also the exact probability over
+        // uniformly shuffled cards.
+        Fraction probability(std::uint64_t count) const;
+    };
+
+    // plays every deal of deck once, split in contiguous ranges of deal
+    // indices across options.threads workers; each worker unranks the start
+    // of its range, so they share nothing until the totals are added up.
+    // throws std::invalid_argument for a reshuffling variant, whose games
+    // depend on more than the deal.
+    Enumeration enumerate(const ReducedDeck &deck, const EnumerationOptions &options);
+} // namespace ariel
@@ -0,0 +1,8 @@
+#include "game.hpp"
+
+#include "game_impl.hpp"
+
+namespace ariel
+{
+    template class BasicGame<ClassicRules>;
+}
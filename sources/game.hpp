@@ -1,21 +1,388 @@
 #pragma once
 
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <memory_resource>
+#include <ranges>
+#include <span>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+#include "card.hpp"
+#include "dealer.hpp"
+#include "game_base.hpp"
+#include "game_observer.hpp"
+#include "outcome_cache.hpp"
 #include "player.hpp"
+#include "rules.hpp"
+#include "turn.hpp"
 
 namespace ariel {
-    class Game
+    class GamePool;
+
+    constexpr std::size_t CACHE_LINE = 64;
+
+    // Selects the BasicGame constructor that deals each card only when a
+    // turn first puts it down.
+    struct LazyDeal
+    {
+    };
+
+    // The engine for one set of rules (see rules.hpp), reporting to an
+    // Observer (see game_observer.hpp). The members are defined in
+    // game_impl.hpp and instantiated for the variants below in game.cpp and
+    // game_variants.cpp, so each one is compiled once with its rules
+    // inlined.
+    template <typename Rules, typename Observer = GameObserver>
+    class BasicGame final : public GameBase
     {
     private:
-        
+        static constexpr unsigned FACE_DOWN = Rules::FACE_DOWN;
+        using Hooks = ObserverHooks<Observer>;
+        // whether a turn calls any hook, see notify().
+        static constexpr bool OBSERVED = Hooks::TURNS;
+
+        // Everything playTurn() reads or writes on a normal turn, in one
+        // cache line of its own. Each player's hand is a run of packed cards
+        // in deck, played from the front; both players always put down the
+        // same number of cards, so one index serves both hands.
+        struct alignas(CACHE_LINE) Hot
+        {
+            static const std::uint8_t HAND = card::DECK_SIZE / 2;
+
+            std::array<std::uint8_t, card::DECK_SIZE> deck; // p1 holds [0, HAND), p2 holds [HAND, DECK_SIZE)
+            std::uint8_t drawn = 0; // cards each player has put down so far
+            std::array<std::uint8_t, 2> taken{};
+            std::uint8_t turns = 0;
+            std::uint8_t draws = 0;
+            std::array<std::uint8_t, 2> wins{};
+            bool finished = false;
+        };
+        static_assert(sizeof(Hot) == CACHE_LINE, "the hot state must fit one cache line");
+
+        // What decides the rest of a reshuffling game without SHUFFLE_WON:
+        // the cards each player will play, in order, their stack followed by
+        // their won pile. the unused ends are zero, so equal positions
+        // compare equal.
+        struct Position
+        {
+            std::array<std::array<std::uint8_t, card::DECK_SIZE>, 2> cards{};
+            std::array<std::uint8_t, 2> count{};
+
+            bool operator==(const Position &) const = default;
+        };
+
+        // With reshuffling the hands differ in size and the won cards are
+        // played again, so each player has a stack and a pile of won cards,
+        // and a game can run for many more turns than 255.
+        struct alignas(CACHE_LINE) Piles
+        {
+            std::array<std::array<std::uint8_t, card::DECK_SIZE>, 2> stack; // stack[s][next[s], end[s]) left to play
+            std::array<std::uint8_t, 2> next{};
+            std::array<std::uint8_t, 2> end{};
+            std::array<std::array<std::uint8_t, card::DECK_SIZE>, 2> won; // won[s][0, wonSize[s])
+            std::array<std::uint8_t, 2> wonSize{};
+            std::uint64_t shuffle = 0; // splitmix64 state for the reshuffles
+            std::array<std::uint64_t, 2> stackHash{}; // of stack[s][next[s], end[s]), see hash()
+            std::array<std::uint64_t, 2> wonHash{};   // of won[s][0, wonSize[s])
+            std::uint32_t turns = 0;
+            std::uint32_t draws = 0;
+            std::array<std::uint32_t, 2> taken{};
+            std::array<std::uint32_t, 2> wins{};
+            bool finished = false;
+            Ending ending = Ending::Playing;
+
+            // Brent's cycle detection, without SHUFFLE_WON: the position
+            // saved when steps last reached power, and the turns since.
+            Position saved;
+            std::uint64_t savedHash = 0;
+            std::uint32_t power = 1;
+            std::uint32_t steps = 0;
+            std::uint32_t cycle = 0; // length of the cycle found
+        };
+
+        using State = std::conditional_t<Rules::RESHUFFLE, Piles, Hot>;
+        using Deck = std::array<std::uint8_t, card::DECK_SIZE>;
+
+        // every card put down in the last turn, in the order described by
+        // turn::play(), and how the turn ended, so the last turn can be
+        // printed even when it wasn't logged. a turn can't use more than the
+        // whole deck, so the buffer is fixed and inline; the spare cards take
+        // the face down write that turn::play() discards.
+        struct alignas(CACHE_LINE) Pot
+        {
+            std::array<std::uint8_t, card::DECK_SIZE + 2 * FACE_DOWN> cards;
+            std::uint8_t size = 0;
+            std::uint8_t faceUp = 0; // face up pairs, the k-th at cards[k * turn::faceUpStride<Rules>()]
+            Outcome outcome = Outcome::Split;
+        };
+
+        State hot_;
+        Pot pot_;
+        Dealer dealer_;
+        [[no_unique_address]] Observer observer_;
+        std::uint32_t turnCap_ = DEFAULT_TURN_CAP;
+        // without reshuffling, the hash of both hands from each index on.
+        std::array<std::uint64_t, card::DECK_SIZE / 2 + 1> handHashes_{};
+
+        // sizes the containers for a whole game and clears the state.
+        void prepare();
+        // deals deck, the first half to p1; shuffle seeds the reshuffles.
+        void deal(const Deck &deck, std::uint64_t shuffle);
+        void hashHands()
+            requires(!Rules::RESHUFFLE);
+        // with a lazy deal, deals each hand up to upTo cards, and makes the
+        // hand hashes once both are whole; dealTurn() deals what the next
+        // turn will put down.
+        void dealTo(unsigned upTo)
+            requires(!Rules::RESHUFFLE);
+        void dealTurn()
+            requires(!Rules::RESHUFFLE);
+        // the deck, with the rest of a lazy deal dealt on a copy.
+        Deck dealtDeck() const
+            requires(!Rules::RESHUFFLE);
+        // the turn just played, which put down wars ties.
+        PlayedTurn playedTurn(unsigned wars) const;
+        // calls the observer's hooks for the turn just played.
+        void notify(unsigned wars)
+            requires(OBSERVED);
+        // plays one turn for turnStream() and describes it in played.
+        // returns false, playing nothing, once the game is over.
+        bool streamTurn(PlayedTurn &played);
+        void restart(Player &p1, Player &p2, const Deck &deck, std::uint64_t shuffle);
+        void finish();
+        void detach();
+        void restore(const GameResult &result)
+            requires(!Rules::RESHUFFLE);
+        template <typename OnFaceUp>
+        bool advance(OnFaceUp &&onFaceUp);
+        template <typename OnFaceUp>
+        turn::Result playHands(OnFaceUp &&onFaceUp);
+        template <typename OnFaceUp>
+        turn::Result playPiles(OnFaceUp &&onFaceUp);
+        Position position() const
+            requires(Rules::RESHUFFLE);
+        std::uint64_t pilesHash(const std::array<std::uint64_t, 2> &stack,
+                                const std::array<std::uint64_t, 2> &won) const
+            requires(Rules::RESHUFFLE);
+        bool repeats()
+            requires(Rules::RESHUFFLE);
+
+        friend class GamePool;
+
     public:
-        Game(Player p1, Player p2) {};
-        ~Game() {};
-
-        void playTurn() {};
-        void printLastTurn() {};
-        void playAll() {};
-        void printWiner() {};
-        void printLog() {};
-        void printStats() {};
+        // binds to both players by reference (they must outlive the game or
+        // its next reset) and deals a freshly shuffled deck, 26 cards to
+        // each player. throws if both arguments are the same player or if
+        // one of them is already playing an unfinished game.
+        // the log and the stats are allocated from resource, e.g. a
+        // per-thread std::pmr::monotonic_buffer_resource released once after
+        // a block of games. they are sized for a whole game up front, so
+        // playing allocates nothing (except for long reshuffle games).
+        // without a seed the deal is random and lazy, as below.
+        BasicGame(Player &p1, Player &p2);
+        BasicGame(Player &p1, Player &p2, std::uint64_t seed,
+                  std::pmr::memory_resource *resource = std::pmr::get_default_resource());
+        // the same, but each card is only dealt when a turn first puts it
+        // down, so a game left after a few turns never shuffles the rest of
+        // the deck. every deal is as likely as with the constructor above,
+        // though seed picks another one. hash(), fastForward() and
+        // playAll(cache) deal the rest first; reshuffling games are dealt in
+        // full here, in the same order.
+        BasicGame(Player &p1, Player &p2, std::uint64_t seed, LazyDeal,
+                  std::pmr::memory_resource *resource = std::pmr::get_default_resource());
+        // the same, with the cards dealt in the order of deal instead of
+        // shuffled: the 52 packed cards (see card::packed()), each exactly
+        // once, the first 26 to p1. a wrong deal throws
+        // std::invalid_argument before the players are taken. with
+        // SHUFFLE_WON the won piles are reshuffled as after seed 0.
+        BasicGame(Player &p1, Player &p2, std::span<const std::uint8_t> deal,
+                  std::pmr::memory_resource *resource = std::pmr::get_default_resource());
+        // the same from a rank string (see canonical.hpp) with 4 of each
+        // rank, e.g. "2345...". the cards of each rank get their suits in
+        // the order of Suit, as no rule looks at suits.
+        BasicGame(Player &p1, Player &p2, std::string_view ranks,
+                  std::pmr::memory_resource *resource = std::pmr::get_default_resource());
+        ~BasicGame();
+
+        // starts over with new players as if freshly constructed, but keeps
+        // the capacity of the log and stats containers. the current players
+        // are released first; if the new ones are rejected the game is left
+        // finished and unbound.
+        void reset(Player &p1, Player &p2, std::uint64_t seed);
+        // the same with a given deal, checked first as by the constructor.
+        void reset(Player &p1, Player &p2, std::span<const std::uint8_t> deal);
+
+        // plays one turn, including every war it triggers. does nothing once
+        // the game is over.
+        void playTurn();
+        void printLastTurn();
+        // plays until the end of the game, logging every turn.
+        void playAll();
+        // the same, but a deal that's in cache isn't played at all: the game
+        // jumps to the stored end, with no log and no last turn. a deal
+        // that isn't is played and stored. a game that has already started
+        // just plays on.
+        void playAll(OutcomeCache &cache)
+            requires(!Rules::RESHUFFLE);
+        // plays until the end like playAll(), but only keeps the counters,
+        // the stats and the last turn: printLog() won't show these turns.
+        void fastForward();
+        void printWiner();
+
+        // The turns still to come as an input range, each one played when
+        // the iteration first reads it or steps past it; begin() and the
+        // comparison with end() play nothing. a consumer sees every turn as
+        // it happens and can stop at any point without the rest being
+        // played, or with a lazy deal dealt. like fastForward(), nothing is
+        // logged; the counters, the stats and the last turn are kept as
+        // usual. nothing is allocated.
+        class TurnStream : public std::ranges::view_interface<TurnStream>
+        {
+        public:
+            class iterator
+            {
+            public:
+                using value_type = PlayedTurn;
+                using difference_type = std::ptrdiff_t;
+
+                iterator() = default;
+
+                const PlayedTurn &operator*() const
+                {
+                    if (pending_)
+                    {
+                        game_->streamTurn(turn_);
+                        pending_ = false;
+                    }
+                    return turn_;
+                }
+                const PlayedTurn *operator->() const { return &**this; }
+                iterator &operator++()
+                {
+                    if (pending_)
+                    {
+                        game_->streamTurn(turn_);
+                    }
+                    pending_ = true;
+                    return *this;
+                }
+                void operator++(int) { ++*this; }
+                bool operator==(std::default_sentinel_t) const
+                {
+                    return game_ == nullptr || (pending_ && game_->finished());
+                }
+
+            private:
+                friend class TurnStream;
+
+                explicit iterator(BasicGame *game) : game_(game) {}
+
+                BasicGame *game_ = nullptr;
+                // whether the turn this iterator stands at is still to be
+                // played, into turn_.
+                mutable bool pending_ = true;
+                mutable PlayedTurn turn_;
+            };
+
+            TurnStream() = default;
+            explicit TurnStream(BasicGame &game) : game_(&game) {}
+
+            iterator begin() const { return iterator(game_); }
+            std::default_sentinel_t end() const { return std::default_sentinel; }
+
+        private:
+            BasicGame *game_ = nullptr;
+        };
+
+        TurnStream turnStream() { return TurnStream(*this); }
+
+        // the observer the hooks are called on, default constructed with the
+        // game and kept across reset().
+        Observer &observer() { return observer_; }
+        const Observer &observer() const { return observer_; }
+        // also prints the allocation counters while alloc::tracking() is on.
+        void printStats();
+
+        // with reshuffling, the game stops with Ending::Capped once this many
+        // turns were played (at least one). kept across reset().
+        void setTurnCap(std::uint32_t cap)
+            requires(Rules::RESHUFFLE)
+        {
+            turnCap_ = cap;
+        }
+
+        bool finished() const { return hot_.finished; }
+        Ending ending() const;
+        // after Ending::Cycle, how many turns the cycle takes.
+        int cycleLength() const
+            requires(Rules::RESHUFFLE)
+        {
+            return static_cast<int>(hot_.cycle);
+        }
+        int turns() const { return static_cast<int>(hot_.turns); }
+        int draws() const { return static_cast<int>(hot_.draws); }
+
+        // cards left in each player's stack; without reshuffling both stacks
+        // are always the same size.
+        int stackSize() const
+            requires(!Rules::RESHUFFLE)
+        {
+            return Hot::HAND - hot_.drawn;
+        }
+        int stackSize(int seat) const override;
+        int cardsTaken(int seat) const override
+        {
+            return static_cast<int>(hot_.taken[static_cast<std::size_t>(seat)]);
+        }
+        int turnsPlayed() const override { return turns(); }
+
+        // a 64-bit hash of everything that decides the rest of the game:
+        // both players' cards in the order they will be played and, without
+        // reshuffling, how many cards each has taken (taken cards are never
+        // played again, so which ones doesn't matter). with SHUFFLE_WON the
+        // split between stack and won pile and the shuffle state count too.
+        // there is no turn order to hash, both players always play at once.
+        // equal positions always hash equal. it is never recomputed: the
+        // dealt hands only lose cards from the top, so their hash comes from
+        // a table of suffixes built by the deal, and with reshuffling every
+        // turn updates the piles' hashes in O(cards moved).
+        std::uint64_t hash() const;
+        // the same hash computed from scratch in O(cards), for checking.
+        std::uint64_t rehash() const;
+
+        // the end of the game as OutcomeCache stores it.
+        GameResult result() const
+            requires(!Rules::RESHUFFLE);
+
+        // the last turn as printLastTurn() prints it, empty before the first
+        // turn or after a cache hit. built on demand, also after
+        // fastForward().
+        std::string lastTurn() const;
+
+        // the winning player, nullptr unless the game ended with
+        // Ending::Won. with reshuffling the winner holds every card.
+        const Player *winner() const;
+
+        // the cards the last turn put in the pot, in the order they were put
+        // down, the first player's before the second player's at each step;
+        // empty before the first turn or after a cache hit.
+        std::vector<card> lastPot() const;
     };
+
+    extern template class BasicGame<ClassicRules>;
+    extern template class BasicGame<AceHighRules>;
+    extern template class BasicGame<FaceDownRules<2>>;
+    extern template class BasicGame<FaceDownRules<3>>;
+    extern template class BasicGame<ReshuffleRules>;
+    extern template class BasicGame<RecycleRules>;
+
+    using Game = BasicGame<ClassicRules>;
+    using AceHighGame = BasicGame<AceHighRules>;
+    using ReshuffleGame = BasicGame<ReshuffleRules>;
+    using RecycleGame = BasicGame<RecycleRules>;
 }
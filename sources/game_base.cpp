@@ -0,0 +1,141 @@
+#include "game_base.hpp"
+
+#include <atomic>
+#include <iostream>
+#include <stdexcept>
+#include <string_view>
+
+#include "trace.hpp"
+
+namespace ariel
+{
+    GameBase::GameBase(Player &p1, Player &p2, std::pmr::memory_resource *resource)
+        : p1_(&p1), p2_(&p2), rounds_(resource), log_(resource), warDepths_(resource)
+    {
+    }
+
+    const GameBase::WarDepths &GameBase::warDepths() const
+    {
+        // the turns without a war are the rest, so playing a turn never
+        // writes here unless it went to war.
+        if (!warDepths_.empty())
+        {
+            int wars = 0;
+            for (std::size_t depth = 1; depth < warDepths_.size(); ++depth)
+            {
+                wars += warDepths_[depth];
+            }
+            warDepths_[0] = turnsPlayed() - wars;
+        }
+        return warDepths_;
+    }
+
+    void GameBase::bind()
+    {
+        if (p1_ == p2_)
+        {
+            throw std::invalid_argument("a player can't play against himself");
+        }
+
+        // every binding gets a fresh token, so a game can only ever release
+        // the binding it made itself.
+        static std::atomic<std::uint64_t> generation{0};
+        token_ = generation.fetch_add(1, std::memory_order_relaxed) + 1;
+
+        if (!p1_->tryAcquire(token_))
+        {
+            throw std::logic_error("a player can only play one game at a time");
+        }
+        if (!p2_->tryAcquire(token_))
+        {
+            p1_->release(token_);
+            throw std::logic_error("a player can only play one game at a time");
+        }
+        p1Name_ = p1_->nameId();
+        p2Name_ = p2_->nameId();
+        p1_->game_ = this;
+        p1_->seat_ = 0;
+        p2_->game_ = this;
+        p2_->seat_ = 1;
+    }
+
+    void GameBase::release()
+    {
+        for (Player *player : {p1_, p2_})
+        {
+            if (player == nullptr)
+            {
+                continue;
+            }
+            if (player->game_ == this)
+            {
+                player->stack_ = stackSize(player->seat_);
+                player->cardsTaken_ = cardsTaken(player->seat_);
+                player->game_ = nullptr;
+            }
+            player->release(token_);
+        }
+    }
+
+    void GameBase::formatTurn(std::string &out, const Round *rounds, std::size_t count, Outcome outcome) const
+    {
+        ARIEL_TRACE_SCOPE("Game::formatLog");
+        const std::string_view first = names::lookup(p1Name_);
+        const std::string_view second = names::lookup(p2Name_);
+        const std::string_view played = " played ";
+        out.reserve(out.size() + count * (first.size() + second.size() + 2 * (played.size() + cards::MAX_NAME) + 12) +
+                    second.size() + 32);
+        for (const Round *round = rounds; round != rounds + count; ++round)
+        {
+            out.append(first).append(played).append(round->first.name());
+            out.append(" ").append(second).append(played).append(round->second.name()).append(". ");
+            if (round->first.rank() == round->second.rank())
+            {
+                out.append("Draw. ");
+            }
+        }
+        switch (outcome)
+        {
+        case Outcome::FirstWins:
+            out.append(first).append(" wins.");
+            break;
+        case Outcome::SecondWins:
+            out.append(second).append(" wins.");
+            break;
+        case Outcome::Split:
+            out.append("Out of cards, the pot is split.");
+            break;
+        }
+    }
+
+    std::string_view GameBase::endingName(Ending ending)
+    {
+        switch (ending)
+        {
+        case Ending::Playing:
+            return "playing";
+        case Ending::Won:
+            return "won";
+        case Ending::Draw:
+            return "draw";
+        case Ending::Cycle:
+            return "cycle";
+        case Ending::Capped:
+            return "capped";
+        }
+        return "";
+    }
+
+    void GameBase::printLog()
+    {
+        std::string line;
+        for (const TurnRecord &turn : log_)
+        {
+            line.clear();
+            formatTurn(line, rounds_.data() + turn.firstRound, turn.rounds, turn.outcome);
+            line += '\n';
+            std::cout << line;
+        }
+        std::cout.flush();
+    }
+} // namespace ariel
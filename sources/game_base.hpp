@@ -0,0 +1,115 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <memory_resource>
+#include <string>
+#include <string_view>
+
+#include "alloc_stats.hpp"
+#include "card.hpp"
+#include "names.hpp"
+#include "player.hpp"
+
+namespace ariel
+{
+    // The part of a game that doesn't depend on the rules: binding the two
+    // players, the turn log and the war depth histogram. Every
+    // BasicGame<Rules> derives from it, and players see their game through
+    // it, whatever the variant.
+    class GameBase
+    {
+    protected:
+        // the log keeps the cards of every round and one small record per
+        // turn; the text is only produced when it is printed.
+        struct Round
+        {
+            card first;
+            card second;
+        };
+
+        // BasicGame computes the outcome as winning seat + 2 * split, so
+        // keep this order.
+        enum class Outcome : std::uint8_t
+        {
+            FirstWins,
+            SecondWins,
+            Split
+        };
+
+        struct TurnRecord
+        {
+            std::uint32_t firstRound; // index into rounds_
+            std::uint32_t rounds;
+            Outcome outcome;
+        };
+
+        using WarDepths = alloc::Vector<int, alloc::Component::Stats>;
+
+        // cold: only touched when binding, on wars, when logging or printing.
+        Player *p1_;
+        Player *p2_;
+        names::Id p1Name_ = 0;
+        names::Id p2Name_ = 0;
+        std::uint64_t token_ = 0; // ownership token held on both players while bound
+        alloc::Vector<Round, alloc::Component::GameLog> rounds_;
+        alloc::Vector<TurnRecord, alloc::Component::GameLog> log_;
+        // warDepths_[d] = turns that needed d consecutive wars. a turn only
+        // counts here if it went to war; warDepths() fills in d = 0.
+        mutable WarDepths warDepths_;
+
+        GameBase(Player &p1, Player &p2, std::pmr::memory_resource *resource);
+        // the derived game releases its players before this runs, while
+        // stackSize() and cardsTaken() still reach it.
+        ~GameBase() = default;
+
+        // takes both players, or throws and takes none.
+        void bind();
+        // gives the players back, leaving the current counts with them.
+        void release();
+        // appends a turn as printLastTurn() prints it; the card names come
+        // from cards::NAMES, so it only copies characters.
+        void formatTurn(std::string &out, const Round *rounds, std::size_t count, Outcome outcome) const;
+
+    public:
+        // how a game ended. only reshuffling games can cycle or be capped.
+        enum class Ending : std::uint8_t
+        {
+            Playing, // not over yet
+            Won,
+            Draw,
+            Cycle, // a position came back, so the game would never end
+            Capped // stopped at the turn cap
+        };
+        // "playing", "won", "draw", "cycle" or "capped".
+        static std::string_view endingName(Ending ending);
+
+        // one turn as BasicGame::turnStream() yields it, the cards packed (see
+        // card::packed()).
+        struct PlayedTurn
+        {
+            std::uint32_t number = 0; // 1 for the first turn
+            // the face up pair that decided the turn, or the last one of a split.
+            std::array<std::uint8_t, 2> faceUp{};
+            std::uint8_t potSize = 0;
+            std::uint8_t wars = 0;
+            std::int8_t winner = -1; // the seat that took the pot, -1 if it was split
+        };
+
+        GameBase(const GameBase &) = delete;
+        GameBase &operator=(const GameBase &) = delete;
+        GameBase(GameBase &&) = delete;
+        GameBase &operator=(GameBase &&) = delete;
+
+        // cards held by the player in seat 0 (p1) or 1 (p2).
+        virtual int stackSize(int seat) const = 0;
+        // cards taken by the player in seat 0 (p1) or 1 (p2).
+        virtual int cardsTaken(int seat) const = 0;
+        virtual int turnsPlayed() const = 0;
+
+        void printLog();
+        // warDepths()[d] = turns that needed d consecutive wars, d >= 0.
+        const WarDepths &warDepths() const;
+    };
+} // namespace ariel
@@ -0,0 +1,1058 @@
+#pragma once
+
+// The members of BasicGame, included by the units that instantiate it:
+// game.cpp for the classic rules and game_variants.cpp for the others. The
+// classic engine is compiled on its own so that how much GCC inlines into
+// its turn loop doesn't depend on how many variants exist.
+
+#include "game.hpp"
+
+#include <algorithm>
+#include <iostream>
+#include <limits>
+#include <optional>
+#include <random>
+#include <stdexcept>
+#include <utility>
+
+#include "canonical.hpp"
+#include "outcome_cache.hpp"
+#include "trace.hpp"
+
+namespace ariel {
+    namespace
+    {
+        // a turn puts down at least one card per player, so a game without
+        // reshuffling has at most this many turns and rounds.
+        const std::size_t MAX_ROUNDS = card::DECK_SIZE / 2;
+
+        // a war puts down FACE_DOWN + 1 more cards per player, so no turn has
+        // more ties than this, given how many cards a player can hold.
+        template <typename Rules>
+        constexpr std::size_t maxWarDepth()
+        {
+            const std::size_t hand = Rules::RESHUFFLE ? card::DECK_SIZE - 1 : card::DECK_SIZE / 2;
+            return (hand + Rules::FACE_DOWN) / (Rules::FACE_DOWN + 1);
+        }
+
+        double rate(int count, int total)
+        {
+            return total == 0 ? 0.0 : 100.0 * count / total;
+        }
+
+        // the rules part of an OutcomeKey, so variants that play the same
+        // deal differently don't share entries. splitmix64 is a bijection,
+        // so rules that play differently never share an id.
+        template <typename Rules>
+        constexpr std::uint64_t rulesKey()
+        {
+            std::uint64_t state = Rules::FACE_DOWN * 2 + (Rules::TWO_BEATS_ACE ? 1 : 0);
+            return splitMix64(state);
+        }
+
+        // splitmix64 as a UniformRandomBitGenerator over a state kept in the
+        // game, for the reshuffles.
+        struct SplitMix
+        {
+            using result_type = std::uint64_t;
+
+            std::uint64_t &state;
+
+            static constexpr result_type min() { return 0; }
+            static constexpr result_type max() { return std::numeric_limits<result_type>::max(); }
+
+            result_type operator()() { return splitMix64(state); }
+        };
+
+        // Keys of the state hash (see BasicGame::hash()), Zobrist style: a
+        // random key per seat and card. A run of cards c_0 .. c_{n-1}, top
+        // first, hashes to the sum of cards[seat][c_i] * BASE^(n-1-i), so a
+        // card's weight only depends on the cards under it: taking the top
+        // card or putting one at the bottom is O(1), and so is moving a
+        // whole pile under another.
+        struct HashKeys
+        {
+            static constexpr std::uint64_t BASE = 0xd6e8feb86659fd93ULL; // odd
+
+            std::array<std::array<std::uint64_t, card::DECK_SIZE>, 2> cards{};
+            std::array<std::array<std::uint64_t, card::DECK_SIZE + 1>, 2> count{}; // per seat, by number of cards
+            std::array<std::uint64_t, card::DECK_SIZE + 1> power{};                // BASE^n
+        };
+
+        constexpr HashKeys HASH_KEYS = [] {
+            HashKeys keys;
+            std::uint64_t state = 0x5eed5eed5eed5eedULL;
+            for (auto &seat : keys.cards)
+            {
+                for (std::uint64_t &key : seat)
+                {
+                    key = splitMix64(state);
+                }
+            }
+            for (auto &seat : keys.count)
+            {
+                for (std::uint64_t &key : seat)
+                {
+                    key = splitMix64(state);
+                }
+            }
+            keys.power[0] = 1;
+            for (std::size_t n = 1; n < keys.power.size(); ++n)
+            {
+                keys.power[n] = keys.power[n - 1] * HashKeys::BASE;
+            }
+            return keys;
+        }();
+
+        using Deck = std::array<std::uint8_t, card::DECK_SIZE>;
+
+        // deal as a deck, if it holds every card once.
+        Deck checkedDeck(std::span<const std::uint8_t> deal)
+        {
+            Deck deck;
+            std::uint64_t seen = 0;
+            if (deal.size() == deck.size())
+            {
+                for (std::size_t i = 0; i < deck.size(); ++i)
+                {
+                    deck[i] = deal[i];
+                    seen |= deal[i] < card::DECK_SIZE ? std::uint64_t{1} << deal[i] : 0;
+                }
+            }
+            if (seen != (std::uint64_t{1} << card::DECK_SIZE) - 1)
+            {
+                throw std::invalid_argument("a deal needs each of the 52 cards exactly once");
+            }
+            return deck;
+        }
+
+        Deck checkedDeck(std::string_view ranks)
+        {
+            const std::optional<canonical::RankKey> key = canonical::parseRanks(ranks);
+            std::array<int, canonical::RANKS> copies{};
+            if (key)
+            {
+                for (std::size_t i = 0; i < key->length; ++i)
+                {
+                    ++copies[static_cast<std::size_t>(key->rank(i))];
+                }
+            }
+            if (!key || key->length != card::DECK_SIZE ||
+                std::any_of(copies.begin(), copies.end(), [](int count) { return count != card::SUITS; }))
+            {
+                throw std::invalid_argument("a rank string deal needs 4 of each of " +
+                                            std::string(canonical::RANK_SYMBOLS));
+            }
+            Deck deck;
+            canonical::representative(*key, deck.data());
+            return deck;
+        }
+
+        // the hash of a run of seat's cards, top first.
+        std::uint64_t runHash(std::size_t seat, const std::uint8_t *cards, std::size_t count)
+        {
+            std::uint64_t hash = 0;
+            for (std::size_t i = 0; i < count; ++i)
+            {
+                hash = hash * HashKeys::BASE + HASH_KEYS.cards[seat][cards[i]];
+            }
+            return hash;
+        }
+    } // namespace
+
+    template <typename Rules, typename Observer>
+    BasicGame<Rules, Observer>::BasicGame(Player &p1, Player &p2)
+        : BasicGame(p1, p2, std::random_device{}(), LazyDeal{})
+    {
+    }
+
+    template <typename Rules, typename Observer>
+    BasicGame<Rules, Observer>::BasicGame(Player &p1, Player &p2, std::uint64_t seed,
+                                          std::pmr::memory_resource *resource)
+        : GameBase(p1, p2, resource)
+    {
+        bind();
+        try
+        {
+            deal(shuffledDeck(seed), seed);
+        }
+        catch (...)
+        {
+            release();
+            throw;
+        }
+    }
+
+    template <typename Rules, typename Observer>
+    BasicGame<Rules, Observer>::BasicGame(Player &p1, Player &p2, std::uint64_t seed, LazyDeal,
+                                          std::pmr::memory_resource *resource)
+        : GameBase(p1, p2, resource)
+    {
+        bind();
+        try
+        {
+            if constexpr (Rules::RESHUFFLE)
+            {
+                deal(lazyDeck(seed), seed);
+            }
+            else
+            {
+                prepare();
+                dealer_ = Dealer::start(seed);
+            }
+        }
+        catch (...)
+        {
+            release();
+            throw;
+        }
+    }
+
+    template <typename Rules, typename Observer>
+    BasicGame<Rules, Observer>::BasicGame(Player &p1, Player &p2, std::span<const std::uint8_t> deal,
+                                          std::pmr::memory_resource *resource)
+        : GameBase(p1, p2, resource)
+    {
+        const Deck deck = checkedDeck(deal);
+        bind();
+        try
+        {
+            this->deal(deck, 0);
+        }
+        catch (...)
+        {
+            release();
+            throw;
+        }
+    }
+
+    template <typename Rules, typename Observer>
+    BasicGame<Rules, Observer>::BasicGame(Player &p1, Player &p2, std::string_view ranks,
+                                          std::pmr::memory_resource *resource)
+        : BasicGame(p1, p2, checkedDeck(ranks), resource)
+    {
+    }
+
+    template <typename Rules, typename Observer>
+    BasicGame<Rules, Observer>::~BasicGame()
+    {
+        release();
+    }
+
+    template <typename Rules, typename Observer>
+    void BasicGame<Rules, Observer>::detach()
+    {
+        release();
+        p1_ = nullptr;
+        p2_ = nullptr;
+        hot_.finished = true;
+    }
+
+    template <typename Rules, typename Observer>
+    void BasicGame<Rules, Observer>::reset(Player &p1, Player &p2, std::uint64_t seed)
+    {
+        restart(p1, p2, shuffledDeck(seed), seed);
+    }
+
+    template <typename Rules, typename Observer>
+    void BasicGame<Rules, Observer>::reset(Player &p1, Player &p2, std::span<const std::uint8_t> deal)
+    {
+        restart(p1, p2, checkedDeck(deal), 0);
+    }
+
+    template <typename Rules, typename Observer>
+    void BasicGame<Rules, Observer>::restart(Player &p1, Player &p2, const Deck &deck, std::uint64_t shuffle)
+    {
+        release();
+        hot_.finished = true;
+        p1_ = &p1;
+        p2_ = &p2;
+        bind();
+
+        rounds_.clear();
+        log_.clear();
+        warDepths_.clear();
+        try
+        {
+            deal(deck, shuffle);
+        }
+        catch (...)
+        {
+            release();
+            throw;
+        }
+    }
+
+    template <typename Rules, typename Observer>
+    void BasicGame<Rules, Observer>::prepare()
+    {
+        // sized for the longest possible game, so no turn ever allocates.
+        rounds_.reserve(MAX_ROUNDS);
+        log_.reserve(MAX_ROUNDS);
+        warDepths_.assign(maxWarDepth<Rules>() + 1, 0);
+
+        hot_ = State{};
+        pot_.size = 0;
+    }
+
+    template <typename Rules, typename Observer>
+    void BasicGame<Rules, Observer>::deal(const Deck &deck, std::uint64_t shuffle)
+    {
+        ARIEL_TRACE_SCOPE("Game::deal");
+        prepare();
+        if constexpr (Rules::RESHUFFLE)
+        {
+            const std::uint8_t hand = card::DECK_SIZE / 2;
+            std::copy_n(deck.begin(), hand, hot_.stack[0].begin());
+            std::copy_n(deck.begin() + hand, hand, hot_.stack[1].begin());
+            hot_.end = {hand, hand};
+            hot_.shuffle = shuffle;
+            hot_.stackHash = {runHash(0, deck.data(), hand), runHash(1, deck.data() + hand, hand)};
+            if constexpr (!Rules::SHUFFLE_WON)
+            {
+                hot_.saved = position();
+                hot_.savedHash = hash();
+            }
+        }
+        else
+        {
+            hot_.deck = deck;
+            dealer_.dealt = Hot::HAND;
+            hashHands();
+        }
+    }
+
+    template <typename Rules, typename Observer>
+    void BasicGame<Rules, Observer>::hashHands()
+        requires(!Rules::RESHUFFLE)
+    {
+        // the hands only ever lose cards from the top, so the hash of what's
+        // left of them is one of these suffixes.
+        const Deck &deck = hot_.deck;
+        handHashes_[Hot::HAND] = 0;
+        for (std::size_t drawn = Hot::HAND; drawn-- > 0;)
+        {
+            handHashes_[drawn] = handHashes_[drawn + 1] +
+                                 (HASH_KEYS.cards[0][deck[drawn]] + HASH_KEYS.cards[1][deck[Hot::HAND + drawn]]) *
+                                     HASH_KEYS.power[Hot::HAND - 1 - drawn];
+        }
+    }
+
+    template <typename Rules, typename Observer>
+    void BasicGame<Rules, Observer>::dealTo(unsigned upTo)
+        requires(!Rules::RESHUFFLE)
+    {
+        if (dealer_.dealt >= upTo)
+        {
+            return;
+        }
+        dealer_.dealTo(hot_.deck, upTo);
+        if (dealer_.dealt == Hot::HAND)
+        {
+            hashHands();
+        }
+    }
+
+    // the face up pairs up to the first that isn't a tie, the face down
+    // cards between them and, when a tie leaves too few cards for a war, the
+    // rest of both hands; see turn::play().
+    template <typename Rules, typename Observer>
+    void BasicGame<Rules, Observer>::dealTurn()
+        requires(!Rules::RESHUFFLE)
+    {
+        for (unsigned faceUp = hot_.drawn;; faceUp += FACE_DOWN + 1)
+        {
+            if (faceUp >= Hot::HAND)
+            {
+                dealTo(Hot::HAND);
+                return;
+            }
+            dealTo(faceUp + 1);
+            if (turn::compare<Rules>(hot_.deck[faceUp], hot_.deck[Hot::HAND + faceUp]) != 0)
+            {
+                return;
+            }
+        }
+    }
+
+    template <typename Rules, typename Observer>
+    typename BasicGame<Rules, Observer>::Deck BasicGame<Rules, Observer>::dealtDeck() const
+        requires(!Rules::RESHUFFLE)
+    {
+        Deck deck = hot_.deck;
+        Dealer rest = dealer_;
+        rest.dealTo(deck, Hot::HAND);
+        return deck;
+    }
+
+    template <typename Rules, typename Observer>
+    std::uint64_t BasicGame<Rules, Observer>::hash() const
+    {
+        if constexpr (Rules::RESHUFFLE)
+        {
+            return pilesHash(hot_.stackHash, hot_.wonHash);
+        }
+        else
+        {
+            if (dealer_.dealt != Hot::HAND)
+            {
+                return rehash(); // no suffixes before the whole deal
+            }
+            return handHashes_[hot_.drawn] + HASH_KEYS.count[0][hot_.taken[0]] + HASH_KEYS.count[1][hot_.taken[1]];
+        }
+    }
+
+    template <typename Rules, typename Observer>
+    std::uint64_t BasicGame<Rules, Observer>::rehash() const
+    {
+        if constexpr (Rules::RESHUFFLE)
+        {
+            std::array<std::uint64_t, 2> stack{};
+            std::array<std::uint64_t, 2> won{};
+            for (std::size_t seat = 0; seat < 2; ++seat)
+            {
+                stack[seat] = runHash(seat, hot_.stack[seat].data() + hot_.next[seat],
+                                      static_cast<std::size_t>(hot_.end[seat] - hot_.next[seat]));
+                won[seat] = runHash(seat, hot_.won[seat].data(), hot_.wonSize[seat]);
+            }
+            return pilesHash(stack, won);
+        }
+        else
+        {
+            const Deck dealt = dealtDeck();
+            const std::uint8_t *deck = dealt.data();
+            return runHash(0, deck + hot_.drawn, Hot::HAND - hot_.drawn) +
+                   runHash(1, deck + Hot::HAND + hot_.drawn, Hot::HAND - hot_.drawn) +
+                   HASH_KEYS.count[0][hot_.taken[0]] + HASH_KEYS.count[1][hot_.taken[1]];
+        }
+    }
+
+    // each player's stack with their won pile under it. with SHUFFLE_WON
+    // the won pile is shuffled before it's played, so where the stack ends
+    // and the shuffle state count as well.
+    template <typename Rules, typename Observer>
+    std::uint64_t BasicGame<Rules, Observer>::pilesHash(const std::array<std::uint64_t, 2> &stack,
+                                                        const std::array<std::uint64_t, 2> &won) const
+        requires(Rules::RESHUFFLE)
+    {
+        std::uint64_t hash = 0;
+        for (std::size_t seat = 0; seat < 2; ++seat)
+        {
+            hash += stack[seat] * HASH_KEYS.power[hot_.wonSize[seat]] + won[seat];
+            if constexpr (Rules::SHUFFLE_WON)
+            {
+                hash += HASH_KEYS.count[seat][hot_.end[seat] - hot_.next[seat]];
+            }
+        }
+        if constexpr (Rules::SHUFFLE_WON)
+        {
+            std::uint64_t shuffle = hot_.shuffle;
+            hash += splitMix64(shuffle);
+        }
+        return hash;
+    }
+
+    template <typename Rules, typename Observer>
+    void BasicGame<Rules, Observer>::finish()
+    {
+        hot_.finished = true;
+        release();
+        if constexpr (Hooks::GAME_END)
+        {
+            observer_.onGameEnd(*this, ending());
+        }
+    }
+
+    template <typename Rules, typename Observer>
+    int BasicGame<Rules, Observer>::stackSize(int seat) const
+    {
+        if constexpr (Rules::RESHUFFLE)
+        {
+            const auto index = static_cast<std::size_t>(seat);
+            return hot_.end[index] - hot_.next[index] + hot_.wonSize[index];
+        }
+        else
+        {
+            return stackSize();
+        }
+    }
+
+    // one turn on the dealt hands, see turn::play(); keeps the score in the
+    // hot state.
+    template <typename Rules, typename Observer>
+    template <typename OnFaceUp>
+    inline turn::Result BasicGame<Rules, Observer>::playHands(OnFaceUp &&onFaceUp)
+    {
+        Hot &hot = hot_;
+        const std::uint8_t *deck = hot.deck.data();
+        const turn::Result played = turn::play<Rules>(deck, deck + Hot::HAND, Hot::HAND, hot.drawn,
+                                                      pot_.cards.data(), std::forward<OnFaceUp>(onFaceUp));
+
+        // who takes what, with selects instead of branches: the winner takes
+        // the cards they won from the other, half the pot; on a split each
+        // takes back their own half.
+        const unsigned size = played.potSize;
+        const bool split = played.split;
+        const auto winner = static_cast<unsigned>(played.compare < 0); // 0 on a split
+        const unsigned half = size / 2;
+        const auto firstTakes = static_cast<unsigned>(split || played.compare > 0);
+        const auto secondTakes = static_cast<unsigned>(split || played.compare < 0);
+        hot.taken[0] = static_cast<std::uint8_t>(hot.taken[0] + half * firstTakes);
+        hot.taken[1] = static_cast<std::uint8_t>(hot.taken[1] + half * secondTakes);
+        hot.wins[winner] = static_cast<std::uint8_t>(hot.wins[winner] + !split);
+        hot.drawn = static_cast<std::uint8_t>(played.drawn);
+        ++hot.turns;
+        hot.draws = static_cast<std::uint8_t>(hot.draws + played.wars);
+        // every face up pair but the last was a war, and so was the last on a split.
+        pot_.faceUp = static_cast<std::uint8_t>(played.wars + !split);
+        return played;
+    }
+
+    // one turn with reshuffling: a player whose stack runs out shuffles the
+    // cards they won into a new stack. a player who can't put down the cards
+    // a war needs throws what they have left and loses the war; if neither
+    // can, each takes back their own cards.
+    template <typename Rules, typename Observer>
+    template <typename OnFaceUp>
+    turn::Result BasicGame<Rules, Observer>::playPiles(OnFaceUp &&onFaceUp)
+    {
+        Piles &hot = hot_;
+        std::uint8_t *pot = pot_.cards.data();
+        unsigned size = 0;
+        // each player's cards in this turn, for a split.
+        std::array<std::array<std::uint8_t, card::DECK_SIZE>, 2> own;
+        std::array<unsigned, 2> owned{};
+
+        const auto put = [&](std::size_t seat, unsigned count) {
+            for (unsigned i = 0; i < count; ++i)
+            {
+                if (hot.next[seat] == hot.end[seat])
+                {
+                    const auto won = hot.won[seat].begin();
+                    const std::uint8_t refill = hot.wonSize[seat];
+                    if constexpr (Rules::SHUFFLE_WON)
+                    {
+                        std::shuffle(won, won + refill, SplitMix{hot.shuffle});
+                        hot.stackHash[seat] = runHash(seat, hot.won[seat].data(), refill);
+                    }
+                    else
+                    {
+                        hot.stackHash[seat] = hot.wonHash[seat];
+                    }
+                    std::copy_n(won, refill, hot.stack[seat].begin());
+                    hot.next[seat] = 0;
+                    hot.end[seat] = refill;
+                    hot.wonSize[seat] = 0;
+                    hot.wonHash[seat] = 0;
+                }
+                const std::uint8_t played = hot.stack[seat][hot.next[seat]];
+                const auto under = static_cast<std::size_t>(hot.end[seat] - hot.next[seat] - 1);
+                hot.stackHash[seat] -= HASH_KEYS.cards[seat][played] * HASH_KEYS.power[under];
+                ++hot.next[seat];
+                pot[size++] = played;
+                own[seat][owned[seat]++] = played;
+            }
+        };
+
+        unsigned wars = 0;
+        unsigned faceUp = 0;
+        int result = 0;
+        bool split = false;
+        while (true)
+        {
+            put(0, 1);
+            put(1, 1);
+            ++faceUp;
+            const std::uint8_t mine = pot[size - 2];
+            const std::uint8_t theirs = pot[size - 1];
+            onFaceUp(mine, theirs);
+            result = turn::compare<Rules>(mine, theirs);
+            if (result != 0)
+            {
+                break;
+            }
+            ++wars;
+            const int needed = FACE_DOWN + 1;
+            const bool firstShort = stackSize(0) < needed;
+            const bool secondShort = stackSize(1) < needed;
+            if (firstShort || secondShort)
+            {
+                put(0, static_cast<unsigned>(stackSize(0)));
+                put(1, static_cast<unsigned>(stackSize(1)));
+                split = firstShort && secondShort;
+                result = split ? 0 : (firstShort ? -1 : 1);
+                break;
+            }
+            put(0, FACE_DOWN);
+            put(1, FACE_DOWN);
+        }
+
+        const auto winner = static_cast<std::size_t>(result < 0);
+        const auto collect = [&hot](std::size_t seat, const std::uint8_t *cards, unsigned count) {
+            std::copy_n(cards, count, hot.won[seat].begin() + hot.wonSize[seat]);
+            hot.wonHash[seat] = hot.wonHash[seat] * HASH_KEYS.power[count] + runHash(seat, cards, count);
+            hot.wonSize[seat] = static_cast<std::uint8_t>(hot.wonSize[seat] + count);
+        };
+        // as without reshuffling, the winner takes the cards they won from
+        // the other and on a split each player takes back their own.
+        if (split)
+        {
+            collect(0, own[0].data(), owned[0]);
+            collect(1, own[1].data(), owned[1]);
+            hot.taken[0] += owned[0];
+            hot.taken[1] += owned[1];
+        }
+        else
+        {
+            collect(winner, pot, size);
+            hot.taken[winner] += owned[1 - winner];
+            ++hot.wins[winner];
+        }
+        ++hot.turns;
+        hot.draws += wars;
+        pot_.faceUp = static_cast<std::uint8_t>(faceUp);
+        return turn::Result{0, size, wars, result, split};
+    }
+
+    // plays one turn and keeps its score: everything but the log. returns
+    // whether the game is over.
+    template <typename Rules, typename Observer>
+    template <typename OnFaceUp>
+    inline bool BasicGame<Rules, Observer>::advance(OnFaceUp &&onFaceUp)
+    {
+        const std::int64_t begin = trace::enabled ? trace::now() : 0;
+        turn::Result played{};
+        if constexpr (Rules::RESHUFFLE)
+        {
+            played = playPiles(std::forward<OnFaceUp>(onFaceUp));
+        }
+        else
+        {
+            played = playHands(std::forward<OnFaceUp>(onFaceUp));
+        }
+        if (played.wars != 0)
+        {
+            ++warDepths_[played.wars];
+        }
+        if constexpr (trace::enabled)
+        {
+            // the pairs are played without branches, so a turn that went to
+            // war is traced as a whole once it's over, whatever its depth.
+            if (played.wars != 0)
+            {
+                trace::record("Game::war", begin, trace::now());
+            }
+        }
+
+        const auto winner = static_cast<unsigned>(played.compare < 0);
+        pot_.size = static_cast<std::uint8_t>(played.potSize);
+        pot_.outcome = static_cast<Outcome>(winner + 2 * unsigned{played.split});
+        if constexpr (OBSERVED)
+        {
+            notify(played.wars);
+        }
+
+        if constexpr (Rules::RESHUFFLE)
+        {
+            if (stackSize(0) == 0 || stackSize(1) == 0)
+            {
+                hot_.ending = Ending::Won;
+            }
+            else if (!Rules::SHUFFLE_WON && repeats())
+            {
+                hot_.ending = Ending::Cycle;
+            }
+            else if (hot_.turns >= turnCap_)
+            {
+                hot_.ending = Ending::Capped;
+            }
+            return hot_.ending != Ending::Playing;
+        }
+        else
+        {
+            return played.drawn == Hot::HAND;
+        }
+    }
+
+    template <typename Rules, typename Observer>
+    typename BasicGame<Rules, Observer>::Position BasicGame<Rules, Observer>::position() const
+        requires(Rules::RESHUFFLE)
+    {
+        Position now;
+        for (std::size_t seat = 0; seat < 2; ++seat)
+        {
+            const auto stack = hot_.stack[seat].begin();
+            const auto out = std::copy(stack + hot_.next[seat], stack + hot_.end[seat], now.cards[seat].begin());
+            std::copy_n(hot_.won[seat].begin(), hot_.wonSize[seat], out);
+            now.count[seat] = static_cast<std::uint8_t>(stackSize(static_cast<int>(seat)));
+        }
+        return now;
+    }
+
+    // Brent's algorithm, one step per turn: the position is compared with
+    // the one saved when steps last reached power, and once steps reaches
+    // power again the current position is saved and power doubles. the
+    // incremental hash() is compared first, so the position is only copied
+    // on a save or a likely repeat, and no history is kept.
+    template <typename Rules, typename Observer>
+    bool BasicGame<Rules, Observer>::repeats()
+        requires(Rules::RESHUFFLE)
+    {
+        Piles &hot = hot_;
+        const std::uint64_t hash = this->hash();
+        ++hot.steps;
+        if (hash == hot.savedHash && position() == hot.saved)
+        {
+            hot.cycle = hot.steps;
+            return true;
+        }
+        if (hot.steps == hot.power)
+        {
+            hot.saved = position();
+            hot.savedHash = hash;
+            hot.power *= 2;
+            hot.steps = 0;
+        }
+        return false;
+    }
+
+    template <typename Rules, typename Observer>
+    GameBase::Ending BasicGame<Rules, Observer>::ending() const
+    {
+        if constexpr (Rules::RESHUFFLE)
+        {
+            return hot_.ending;
+        }
+        else if (!hot_.finished)
+        {
+            return Ending::Playing;
+        }
+        else
+        {
+            return hot_.taken[0] == hot_.taken[1] ? Ending::Draw : Ending::Won;
+        }
+    }
+
+    template <typename Rules, typename Observer>
+    void BasicGame<Rules, Observer>::playTurn()
+    {
+        if (hot_.finished)
+        {
+            return;
+        }
+        ARIEL_TRACE_SCOPE("Game::playTurn");
+        if constexpr (!Rules::RESHUFFLE)
+        {
+            if (dealer_.dealt != Hot::HAND)
+            {
+                dealTurn();
+            }
+        }
+
+        const auto firstRound = static_cast<std::uint32_t>(rounds_.size());
+        const bool over = advance([this](std::uint8_t mine, std::uint8_t theirs) {
+            rounds_.push_back(Round{card::fromPacked(mine), card::fromPacked(theirs)});
+        });
+        log_.push_back(TurnRecord{firstRound, pot_.faceUp, pot_.outcome});
+
+        if (over)
+        {
+            finish();
+        }
+    }
+
+    template <typename Rules, typename Observer>
+    GameBase::PlayedTurn BasicGame<Rules, Observer>::playedTurn(unsigned wars) const
+    {
+        const std::size_t last = turn::faceUpStride<Rules>() * (pot_.faceUp - 1U);
+        PlayedTurn played;
+        played.number = static_cast<std::uint32_t>(hot_.turns);
+        played.faceUp = {pot_.cards[last], pot_.cards[last + 1]};
+        played.potSize = pot_.size;
+        played.wars = static_cast<std::uint8_t>(wars);
+        played.winner = pot_.outcome == Outcome::Split ? std::int8_t{-1} : static_cast<std::int8_t>(pot_.outcome);
+        return played;
+    }
+
+    template <typename Rules, typename Observer>
+    void BasicGame<Rules, Observer>::notify(unsigned wars)
+        requires(OBSERVED)
+    {
+        // only the hooks the observer hides are called, and a PlayedTurn is
+        // only built for one that takes it.
+        if constexpr (Hooks::WAR_START)
+        {
+            // the face up pairs are still in the pot, the tied ones first.
+            const std::size_t stride = turn::faceUpStride<Rules>();
+            for (unsigned depth = 1; depth <= wars; ++depth)
+            {
+                const std::size_t pair = stride * (depth - 1);
+                observer_.onWarStart(depth, pot_.cards[pair], pot_.cards[pair + 1]);
+            }
+        }
+        const bool split = pot_.outcome == Outcome::Split;
+        if constexpr (Hooks::SPLIT)
+        {
+            if (split)
+            {
+                observer_.onSplit(playedTurn(wars));
+            }
+        }
+        if constexpr (Hooks::WAR_RESOLVED)
+        {
+            if (!split && wars != 0)
+            {
+                observer_.onWarResolved(wars, static_cast<int>(pot_.outcome));
+            }
+        }
+        if constexpr (Hooks::TURN)
+        {
+            observer_.onTurn(playedTurn(wars));
+        }
+    }
+
+    template <typename Rules, typename Observer>
+    bool BasicGame<Rules, Observer>::streamTurn(PlayedTurn &played)
+    {
+        if (hot_.finished)
+        {
+            return false;
+        }
+        ARIEL_TRACE_SCOPE("Game::streamTurn");
+        if constexpr (!Rules::RESHUFFLE)
+        {
+            if (dealer_.dealt != Hot::HAND)
+            {
+                dealTurn();
+            }
+        }
+
+        const auto draws = hot_.draws;
+        const bool over = advance([](std::uint8_t, std::uint8_t) {});
+        played = playedTurn(static_cast<unsigned>(hot_.draws - draws));
+
+        if (over)
+        {
+            finish();
+        }
+        return true;
+    }
+
+    template <typename Rules, typename Observer>
+    void BasicGame<Rules, Observer>::playAll()
+    {
+        ARIEL_TRACE_SCOPE("Game::playAll");
+        while (!hot_.finished)
+        {
+            playTurn();
+        }
+    }
+
+    template <typename Rules, typename Observer>
+    void BasicGame<Rules, Observer>::playAll(OutcomeCache &cache)
+        requires(!Rules::RESHUFFLE)
+    {
+        if (hot_.finished)
+        {
+            return;
+        }
+        if (hot_.turns != 0)
+        {
+            playAll();
+            return;
+        }
+        // the deck is untouched before the first turn, and only its ranks
+        // decide the game, so deals that differ in suits share an entry.
+        dealTo(Hot::HAND);
+        const OutcomeKey key{canonical::canonicalize(hot_.deck.data(), hot_.deck.size()).key, rulesKey<Rules>()};
+        if (const std::optional<GameResult> cached = cache.find(key))
+        {
+            ARIEL_TRACE_SCOPE("Game::restore");
+            restore(*cached);
+            finish();
+            return;
+        }
+        playAll();
+        cache.insert(key, result());
+    }
+
+    template <typename Rules, typename Observer>
+    GameResult BasicGame<Rules, Observer>::result() const
+        requires(!Rules::RESHUFFLE)
+    {
+        static_assert(maxWarDepth<Rules>() <= GameResult::MAX_WAR_DEPTH);
+        GameResult result;
+        result.turns = hot_.turns;
+        result.draws = hot_.draws;
+        result.taken = hot_.taken;
+        result.wins = hot_.wins;
+        const WarDepths &depths = warDepths();
+        for (std::size_t depth = 0; depth < depths.size(); ++depth)
+        {
+            result.warDepths[depth] = static_cast<std::uint8_t>(depths[depth]);
+        }
+        return result;
+    }
+
+    template <typename Rules, typename Observer>
+    void BasicGame<Rules, Observer>::restore(const GameResult &result)
+        requires(!Rules::RESHUFFLE)
+    {
+        hot_.drawn = Hot::HAND;
+        hot_.turns = result.turns;
+        hot_.draws = result.draws;
+        hot_.taken = result.taken;
+        hot_.wins = result.wins;
+        for (std::size_t depth = 0; depth < warDepths_.size(); ++depth)
+        {
+            warDepths_[depth] = result.warDepths[depth];
+        }
+        pot_.size = 0; // no last turn to show
+        pot_.faceUp = 0;
+    }
+
+    template <typename Rules, typename Observer>
+    void BasicGame<Rules, Observer>::fastForward()
+    {
+        if (hot_.finished)
+        {
+            return;
+        }
+        ARIEL_TRACE_SCOPE("Game::fastForward");
+        if constexpr (!Rules::RESHUFFLE)
+        {
+            dealTo(Hot::HAND);
+        }
+        while (!advance([](std::uint8_t, std::uint8_t) {}))
+        {
+        }
+        finish();
+    }
+
+    template <typename Rules, typename Observer>
+    std::vector<card> BasicGame<Rules, Observer>::lastPot() const
+    {
+        std::vector<card> cards;
+        cards.reserve(pot_.size);
+        for (std::size_t i = 0; i < pot_.size; ++i)
+        {
+            cards.push_back(card::fromPacked(pot_.cards[i]));
+        }
+        return cards;
+    }
+
+    template <typename Rules, typename Observer>
+    const Player *BasicGame<Rules, Observer>::winner() const
+    {
+        if (!hot_.finished)
+        {
+            return nullptr;
+        }
+        if constexpr (Rules::RESHUFFLE)
+        {
+            if (hot_.ending != Ending::Won)
+            {
+                return nullptr;
+            }
+            return stackSize(0) == 0 ? p2_ : p1_;
+        }
+        else
+        {
+            if (hot_.taken[0] == hot_.taken[1])
+            {
+                return nullptr;
+            }
+            return hot_.taken[0] > hot_.taken[1] ? p1_ : p2_;
+        }
+    }
+
+    template <typename Rules, typename Observer>
+    std::string BasicGame<Rules, Observer>::lastTurn() const
+    {
+        if (pot_.size == 0)
+        {
+            return "";
+        }
+        // the face up pairs of the last turn are still in the pot, whether
+        // or not it was logged.
+        const std::size_t stride = turn::faceUpStride<Rules>();
+        std::vector<Round> rounds;
+        rounds.reserve(pot_.faceUp);
+        for (std::size_t i = 0; i < pot_.faceUp; ++i)
+        {
+            rounds.push_back(
+                Round{card::fromPacked(pot_.cards[stride * i]), card::fromPacked(pot_.cards[stride * i + 1])});
+        }
+        std::string out;
+        formatTurn(out, rounds.data(), rounds.size(), pot_.outcome);
+        return out;
+    }
+
+    template <typename Rules, typename Observer>
+    void BasicGame<Rules, Observer>::printLastTurn()
+    {
+        if (hot_.turns == 0)
+        {
+            std::cout << "No turn was played yet." << std::endl;
+            return;
+        }
+        if (pot_.size == 0)
+        {
+            std::cout << "The result came from a cache, no turn was played." << std::endl;
+            return;
+        }
+        std::cout << lastTurn() << std::endl;
+    }
+
+    template <typename Rules, typename Observer>
+    void BasicGame<Rules, Observer>::printWiner()
+    {
+        if (!hot_.finished)
+        {
+            std::cout << "The game is not over yet." << std::endl;
+            return;
+        }
+        if constexpr (Rules::RESHUFFLE)
+        {
+            if (hot_.ending == Ending::Cycle)
+            {
+                std::cout << "No winner, the game repeats every " << hot_.cycle << " turns." << std::endl;
+                return;
+            }
+            if (hot_.ending == Ending::Capped)
+            {
+                std::cout << "No winner after " << turns() << " turns." << std::endl;
+                return;
+            }
+        }
+        const Player *won = winner();
+        std::cout << (won == nullptr ? "Draw." : won->name()) << std::endl;
+    }
+
+    template <typename Rules, typename Observer>
+    void BasicGame<Rules, Observer>::printStats()
+    {
+        const int turns = this->turns();
+        std::cout << "Turns played: " << turns << '\n';
+        for (int seat = 0; seat < 2; ++seat)
+        {
+            const auto wins = static_cast<int>(hot_.wins[static_cast<std::size_t>(seat)]);
+            std::cout << names::lookup(seat == 0 ? p1Name_ : p2Name_) << ": win rate " << rate(wins, turns)
+                      << "%, turns won " << wins << ", cards won " << cardsTaken(seat) << '\n';
+        }
+        std::cout << "Draws: " << draws() << ", draw rate " << rate(draws(), turns) << "%\n";
+        for (std::size_t depth = 1; depth < warDepths_.size(); ++depth)
+        {
+            if (warDepths_[depth] != 0)
+            {
+                std::cout << "  turns with " << depth << " consecutive draws: " << warDepths_[depth] << '\n';
+            }
+        }
+        if (alloc::tracking())
+        {
+            std::cout << "Allocations since the counters were reset:\n";
+            alloc::print(std::cout);
+        }
+        std::cout.flush();
+    }
+}
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <cstdint>
+#include <type_traits>
+
+#include "game_base.hpp"
+
+namespace ariel
+{
+    // The hooks a BasicGame calls as it plays, for analytics without
+    // changing the engine. An observer derives from GameObserver, hides the
+    // hooks it wants and is passed as BasicGame's second parameter, e.g.
+    // BasicGame<ClassicRules, WarCounter>; the game holds one (see
+    // BasicGame::observer()). The hooks are called directly, not through
+    // virtual functions, and only the ones the observer hides are called
+    // (see ObserverHooks): a game doesn't even compute the arguments of the
+    // others, so one whose observer hides nothing compiles to the same code
+    // as one without.
+    //
+    // The hooks of a turn run once it is over, in the order it was played:
+    // onWarStart() for each tie, then onWarResolved() or onSplit(), then
+    // onTurn(). They run inside the turn loop, so they shouldn't throw or
+    // allocate; everything they are given is a value or a reference into
+    // the game.
+    //
+    // A game with another observer is compiled from game_impl.hpp, in a unit
+    // of its own as game.cpp does for Game.
+    struct GameObserver
+    {
+        // a face up pair tied, the depth-th in a row this turn (from 1): a
+        // war started, or the turn ended in a split if the hands ran out.
+        // like every hook of a turn it runs once the turn is over and the
+        // pot is already taken, not while the war is played. the cards are
+        // packed (see card::packed()).
+        void onWarStart(unsigned /*depth*/, std::uint8_t /*first*/, std::uint8_t /*second*/) {}
+        // a face up pair ended depth wars; seat took the pot.
+        void onWarResolved(unsigned /*depth*/, int /*seat*/) {}
+        // the hands ran out on a tie and the pot was shared.
+        void onSplit(const GameBase::PlayedTurn & /*turn*/) {}
+        // after every turn.
+        void onTurn(const GameBase::PlayedTurn & /*turn*/) {}
+        // once the game is over, however it ended, also when the result came
+        // from an OutcomeCache and no turn was seen.
+        void onGameEnd(const GameBase & /*game*/, GameBase::Ending /*ending*/) {}
+    };
+
+    // Which of GameObserver's hooks Observer hides. A hook Observer doesn't
+    // declare is GameObserver's own, so its member pointer has
+    // GameObserver's type. Hooks must be plain member functions, not
+    // templates or overloads.
+    template <typename Observer>
+    struct ObserverHooks
+    {
+        template <typename Hook, typename Empty>
+        static constexpr bool HIDES = !std::is_same_v<Hook, Empty>;
+
+        static constexpr bool WAR_START =
+            HIDES<decltype(&Observer::onWarStart), decltype(&GameObserver::onWarStart)>;
+        static constexpr bool WAR_RESOLVED =
+            HIDES<decltype(&Observer::onWarResolved), decltype(&GameObserver::onWarResolved)>;
+        static constexpr bool SPLIT = HIDES<decltype(&Observer::onSplit), decltype(&GameObserver::onSplit)>;
+        static constexpr bool TURN = HIDES<decltype(&Observer::onTurn), decltype(&GameObserver::onTurn)>;
+        static constexpr bool GAME_END = HIDES<decltype(&Observer::onGameEnd), decltype(&GameObserver::onGameEnd)>;
+        // any hook called from the turn loop.
+        static constexpr bool TURNS = WAR_START || WAR_RESOLVED || SPLIT || TURN;
+    };
+} // namespace ariel
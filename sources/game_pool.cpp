@@ -0,0 +1,76 @@
+#include "game_pool.hpp"
+
+#include <random>
+#include <utility>
+
+namespace ariel
+{
+    GamePool::Handle::~Handle()
+    {
+        if (game_)
+        {
+            pool_->reclaim(std::move(game_));
+        }
+    }
+
+    GamePool::Handle &GamePool::Handle::operator=(Handle &&other) noexcept
+    {
+        if (this != &other)
+        {
+            if (game_)
+            {
+                pool_->reclaim(std::move(game_));
+            }
+            pool_ = other.pool_;
+            game_ = std::move(other.game_);
+        }
+        return *this;
+    }
+
+    GamePool::GamePool(std::pmr::memory_resource *resource, std::size_t maxIdle)
+        : resource_(resource), maxIdle_(maxIdle)
+    {
+        idle_.reserve(maxIdle_);
+    }
+
+    GamePool &GamePool::local()
+    {
+        thread_local GamePool pool;
+        return pool;
+    }
+
+    GamePool::Handle GamePool::acquire(Player &p1, Player &p2, std::uint64_t seed)
+    {
+        if (idle_.empty())
+        {
+            return Handle(*this, std::make_unique<Game>(p1, p2, seed, resource_));
+        }
+        std::unique_ptr<Game> game = std::move(idle_.back());
+        idle_.pop_back();
+        try
+        {
+            game->reset(p1, p2, seed);
+        }
+        catch (...)
+        {
+            reclaim(std::move(game));
+            throw;
+        }
+        return Handle(*this, std::move(game));
+    }
+
+    GamePool::Handle GamePool::acquire(Player &p1, Player &p2)
+    {
+        return acquire(p1, p2, std::random_device{}());
+    }
+
+    void GamePool::reclaim(std::unique_ptr<Game> game) noexcept
+    {
+        // an abandoned game must not keep its players from joining another.
+        game->detach();
+        if (idle_.size() < maxIdle_)
+        {
+            idle_.push_back(std::move(game));
+        }
+    }
+}
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <memory_resource>
+#include <vector>
+
+#include "game.hpp"
+
+namespace ariel
+{
+    // Recycles Game objects for workloads that play many short-lived games
+    // back to back. A reclaimed game keeps its log and stats capacity, so
+    // acquiring it again costs a Game::reset() instead of a construction.
+    //
+    // A pool is not thread safe; use GamePool::local() for the calling
+    // thread's pool.
+    class GamePool
+    {
+    public:
+        // owns an acquired game and gives it back to its pool when destroyed.
+        class Handle
+        {
+        private:
+            GamePool *pool_;
+            std::unique_ptr<Game> game_;
+
+        public:
+            Handle(GamePool &pool, std::unique_ptr<Game> game) : pool_(&pool), game_(std::move(game)) {}
+            ~Handle();
+
+            Handle(Handle &&other) noexcept = default;
+            Handle &operator=(Handle &&other) noexcept;
+            Handle(const Handle &) = delete;
+            Handle &operator=(const Handle &) = delete;
+
+            Game &operator*() const { return *game_; }
+            Game *operator->() const { return game_.get(); }
+        };
+
+        static const std::size_t DEFAULT_MAX_IDLE = 64;
+
+        explicit GamePool(std::pmr::memory_resource *resource = std::pmr::get_default_resource(),
+                          std::size_t maxIdle = DEFAULT_MAX_IDLE);
+
+        // the calling thread's pool, allocating from the default resource.
+        static GamePool &local();
+
+        // a game between p1 and p2, dealt with seed. throws like Game's
+        // constructor if the players are rejected.
+        Handle acquire(Player &p1, Player &p2, std::uint64_t seed);
+        Handle acquire(Player &p1, Player &p2);
+
+        std::size_t idle() const { return idle_.size(); }
+        void clear() { idle_.clear(); }
+
+    private:
+        std::pmr::memory_resource *resource_;
+        std::size_t maxIdle_;
+        std::vector<std::unique_ptr<Game>> idle_;
+
+        // called from Handle's noexcept members: idle_ has room for
+        // maxIdle_ games from the start, so keeping one never allocates.
+        void reclaim(std::unique_ptr<Game> game) noexcept;
+    };
+}
@@ -0,0 +1,12 @@
+#include "game.hpp"
+
+#include "game_impl.hpp"
+
+namespace ariel
+{
+    template class BasicGame<AceHighRules>;
+    template class BasicGame<FaceDownRules<2>>;
+    template class BasicGame<FaceDownRules<3>>;
+    template class BasicGame<ReshuffleRules>;
+    template class BasicGame<RecycleRules>;
+}
@@ -0,0 +1,198 @@
+#include "names.hpp"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <cstring>
+#include <memory_resource>
+#include <mutex>
+#include <stdexcept>
+
+#include "alloc_stats.hpp"
+
+namespace ariel
+{
+    namespace names
+    {
+        namespace
+        {
+            // ids are stored in segments of doubling size: segment k holds
+            // 2^k entries, so the entries never move and a lookup needs no
+            // lock, just one acquire load of the segment pointer.
+            const std::size_t SEGMENTS = 32;
+            const std::size_t INITIAL_SLOTS = 64;
+            const std::size_t CHAR_BLOCK = 4096;
+
+            template <typename T>
+            using Allocator = alloc::TrackedAllocator<T, alloc::Component::Name>;
+
+            // open addressing table of id + 1, 0 marks an empty slot. a full
+            // table is replaced by one twice as big; readers that still hold
+            // the old one may miss a new name and fall back to the locked path.
+            struct Table
+            {
+                std::size_t mask;
+                alloc::Vector<std::atomic<Id>, alloc::Component::Name> slots;
+
+                explicit Table(std::size_t capacity)
+                    : mask(capacity - 1), slots(capacity, Allocator<std::atomic<Id>>(std::pmr::new_delete_resource()))
+                {
+                }
+            };
+
+            struct Registry
+            {
+                std::array<std::atomic<std::string_view *>, SEGMENTS> segments{};
+                std::atomic<Table *> table{nullptr};
+
+                // everything below is only touched while holding mutex.
+                std::mutex mutex;
+                std::uint32_t count = 0;
+                char *chars = nullptr;
+                std::size_t charsLeft = 0;
+            };
+
+            // never destroyed, so names stay valid during static destruction.
+            Registry &registry()
+            {
+                static Registry *reg = new Registry();
+                return *reg;
+            }
+
+            std::uint64_t hash(std::string_view name)
+            {
+                // FNV-1a
+                std::uint64_t value = 14695981039346656037ULL;
+                for (char chr : name)
+                {
+                    value ^= static_cast<unsigned char>(chr);
+                    value *= 1099511628211ULL;
+                }
+                return value;
+            }
+
+            std::string_view &entry(std::string_view *segment, std::uint64_t index)
+            {
+                const auto offset = index - (std::uint64_t{1} << (std::bit_width(index) - 1));
+                return segment[offset];
+            }
+
+            std::size_t segmentOf(std::uint64_t index)
+            {
+                return static_cast<std::size_t>(std::bit_width(index) - 1);
+            }
+
+            // returns id + 1, or 0 if name isn't in table.
+            Id find(const Table *table, std::string_view name, std::uint64_t hashed)
+            {
+                if (table == nullptr)
+                {
+                    return 0;
+                }
+                for (std::size_t i = hashed & table->mask;; i = (i + 1) & table->mask)
+                {
+                    const Id slot = table->slots[i].load(std::memory_order_acquire);
+                    if (slot == 0 || lookup(slot - 1) == name)
+                    {
+                        return slot;
+                    }
+                }
+            }
+
+            void insert(Table &table, Id slot, std::uint64_t hashed)
+            {
+                std::size_t i = hashed & table.mask;
+                while (table.slots[i].load(std::memory_order_relaxed) != 0)
+                {
+                    i = (i + 1) & table.mask;
+                }
+                table.slots[i].store(slot, std::memory_order_release);
+            }
+
+            std::string_view copyChars(Registry &reg, std::string_view name)
+            {
+                if (name.empty())
+                {
+                    return {};
+                }
+                if (reg.charsLeft < name.size())
+                {
+                    const std::size_t size = std::max(CHAR_BLOCK, name.size());
+                    reg.chars = Allocator<char>(std::pmr::new_delete_resource()).allocate(size);
+                    reg.charsLeft = size;
+                }
+                char *stored = reg.chars;
+                std::memcpy(stored, name.data(), name.size());
+                reg.chars += name.size();
+                reg.charsLeft -= name.size();
+                return {stored, name.size()};
+            }
+        } // namespace
+
+        Id intern(std::string_view name)
+        {
+            Registry &reg = registry();
+            const std::uint64_t hashed = hash(name);
+            if (const Id slot = find(reg.table.load(std::memory_order_acquire), name, hashed))
+            {
+                return slot - 1;
+            }
+
+            const std::lock_guard<std::mutex> lock(reg.mutex);
+            Table *table = reg.table.load(std::memory_order_relaxed);
+            if (const Id slot = find(table, name, hashed))
+            {
+                return slot - 1;
+            }
+            if (reg.count == UINT32_MAX - 1)
+            {
+                throw std::length_error("too many interned names");
+            }
+
+            const Id id = reg.count;
+            const std::uint64_t index = std::uint64_t{id} + 1;
+            const std::size_t segment = segmentOf(index);
+            std::string_view *entries = reg.segments[segment].load(std::memory_order_relaxed);
+            if (entries == nullptr)
+            {
+                const std::size_t size = std::size_t{1} << segment;
+                entries = Allocator<std::string_view>(std::pmr::new_delete_resource()).allocate(size);
+                reg.segments[segment].store(entries, std::memory_order_release);
+            }
+            entry(entries, index) = copyChars(reg, name);
+            ++reg.count;
+
+            // keep the table at most half full.
+            if (table == nullptr || 2 * std::size_t{reg.count} > table->mask + 1)
+            {
+                const std::size_t capacity = table == nullptr ? INITIAL_SLOTS : 2 * (table->mask + 1);
+                auto *grown = new Table(capacity);
+                for (Id other = 0; other < id; ++other)
+                {
+                    insert(*grown, other + 1, hash(lookup(other)));
+                }
+                // the old table is leaked on purpose: a reader may still be
+                // probing it.
+                table = grown;
+                reg.table.store(grown, std::memory_order_release);
+            }
+            insert(*table, id + 1, hashed);
+            return id;
+        }
+
+        std::string_view lookup(Id id)
+        {
+            const std::uint64_t index = std::uint64_t{id} + 1;
+            std::string_view *entries = registry().segments[segmentOf(index)].load(std::memory_order_acquire);
+            return entry(entries, index);
+        }
+
+        std::uint32_t size()
+        {
+            Registry &reg = registry();
+            const std::lock_guard<std::mutex> lock(reg.mutex);
+            return reg.count;
+        }
+    } // namespace names
+} // namespace ariel
@@ -0,0 +1,28 @@
+#pragma once
+
+#include <cstdint>
+#include <string_view>
+
+// Process-wide table of interned player names.
+//
+// Players and turn logs keep a 32-bit id instead of a string; the text is
+// only looked up when something is printed. Looking up an id, and interning
+// a name that is already in the table, never take a lock. Adding a new name
+// is serialized by a mutex. Interned names are never removed.
+
+namespace ariel
+{
+    namespace names
+    {
+        using Id = std::uint32_t;
+
+        // the id of name, adding it to the table on first use.
+        Id intern(std::string_view name);
+
+        // the name interned as id. the view stays valid until the program exits.
+        std::string_view lookup(Id id);
+
+        // number of distinct names interned so far.
+        std::uint32_t size();
+    } // namespace names
+} // namespace ariel
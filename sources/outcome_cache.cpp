@@ -0,0 +1,125 @@
+#include "outcome_cache.hpp"
+
+#include <algorithm>
+#include <bit>
+
+namespace ariel
+{
+    double OutcomeCache::Stats::hitRate() const
+    {
+        const std::uint64_t lookups = hits + misses;
+        return lookups == 0 ? 0.0 : static_cast<double>(hits) / static_cast<double>(lookups);
+    }
+
+    OutcomeCache::OutcomeCache(std::size_t capacity, std::pmr::memory_resource *resource)
+        : sets_(std::bit_ceil(std::max<std::size_t>(1, (capacity + WAYS - 1) / WAYS)), Set{}, resource)
+    {
+    }
+
+    std::size_t OutcomeCache::setOf(std::uint64_t hash) const
+    {
+        // a hash may be weak in its low bits, as a polynomial hash is; a
+        // multiply moves every bit into the high ones, which pick the set.
+        const int bits = std::countr_zero(sets_.size());
+        return bits == 0 ? 0 : static_cast<std::size_t>((hash * 0x9e3779b97f4a7c15ULL) >> (64 - bits));
+    }
+
+    std::optional<GameResult> OutcomeCache::find(const OutcomeKey &key)
+    {
+        const std::uint64_t hash = key.hash();
+        const std::size_t index = setOf(hash);
+        Stripe &stripe = stripeOf(index);
+        const std::lock_guard<std::mutex> lock(stripe.mutex);
+        for (Entry &entry : sets_[index].entries)
+        {
+            if (entry.used && entry.hash == hash && entry.key == key)
+            {
+                entry.referenced = true;
+                ++stripe.stats.hits;
+                return entry.result;
+            }
+        }
+        ++stripe.stats.misses;
+        return std::nullopt;
+    }
+
+    void OutcomeCache::insert(const OutcomeKey &key, const GameResult &result)
+    {
+        const std::uint64_t hash = key.hash();
+        const std::size_t index = setOf(hash);
+        Stripe &stripe = stripeOf(index);
+        const std::lock_guard<std::mutex> lock(stripe.mutex);
+        Set &set = sets_[index];
+
+        Entry *free = nullptr;
+        for (Entry &entry : set.entries)
+        {
+            if (entry.used && entry.hash == hash && entry.key == key)
+            {
+                // another thread played the same deal meanwhile.
+                entry.result = result;
+                return;
+            }
+            if (!entry.used && free == nullptr)
+            {
+                free = &entry;
+            }
+        }
+        if (free == nullptr)
+        {
+            // at most one pass unmarks every entry, so this ends within two.
+            while (set.entries[set.hand].referenced)
+            {
+                set.entries[set.hand].referenced = false;
+                set.hand = static_cast<std::uint8_t>((set.hand + 1) % WAYS);
+            }
+            free = &set.entries[set.hand];
+            set.hand = static_cast<std::uint8_t>((set.hand + 1) % WAYS);
+            ++stripe.stats.evictions;
+        }
+        *free = Entry{hash, key, result, true, false};
+        ++stripe.stats.insertions;
+    }
+
+    OutcomeCache::Stats OutcomeCache::stats() const
+    {
+        Stats total;
+        for (const Stripe &stripe : stripes_)
+        {
+            const std::lock_guard<std::mutex> lock(stripe.mutex);
+            total.hits += stripe.stats.hits;
+            total.misses += stripe.stats.misses;
+            total.insertions += stripe.stats.insertions;
+            total.evictions += stripe.stats.evictions;
+        }
+        return total;
+    }
+
+    std::size_t OutcomeCache::size() const
+    {
+        std::size_t used = 0;
+        for (std::size_t index = 0; index < sets_.size(); ++index)
+        {
+            const std::lock_guard<std::mutex> lock(stripes_[index % STRIPES].mutex);
+            for (const Entry &entry : sets_[index].entries)
+            {
+                used += entry.used ? 1 : 0;
+            }
+        }
+        return used;
+    }
+
+    void OutcomeCache::clear()
+    {
+        for (std::size_t index = 0; index < sets_.size(); ++index)
+        {
+            const std::lock_guard<std::mutex> lock(stripes_[index % STRIPES].mutex);
+            sets_[index] = Set{};
+        }
+        for (Stripe &stripe : stripes_)
+        {
+            const std::lock_guard<std::mutex> lock(stripe.mutex);
+            stripe.stats = Stats{};
+        }
+    }
+} // namespace ariel
@@ -0,0 +1,117 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <memory_resource>
+#include <mutex>
+#include <optional>
+
+#include "alloc_stats.hpp"
+#include "canonical.hpp"
+#include "card.hpp"
+
+namespace ariel
+{
+    // Everything a game without reshuffling keeps once it's over, except
+    // the log and the last turn.
+    struct GameResult
+    {
+        // a war takes at least two cards from each hand of 26.
+        static const std::size_t MAX_WAR_DEPTH = card::DECK_SIZE / 4;
+
+        std::uint8_t turns = 0;
+        std::uint8_t draws = 0;
+        std::array<std::uint8_t, 2> taken{};
+        std::array<std::uint8_t, 2> wins{};
+        std::array<std::uint8_t, MAX_WAR_DEPTH + 1> warDepths{}; // as in GameBase::warDepths()
+    };
+
+    // What OutcomeCache looks a result up by: the ranks of a whole deal
+    // (see canonical.hpp) and an id of the rules that play it. Entries
+    // match on the whole key; its hash only picks the set.
+    struct OutcomeKey
+    {
+        canonical::RankKey ranks;
+        std::uint64_t rules = 0;
+
+        bool operator==(const OutcomeKey &) const = default;
+        std::uint64_t hash() const { return ranks.hash() ^ rules; }
+    };
+
+    // A bounded map from deals to results, shared by any number of threads
+    // (see BasicGame::playAll(OutcomeCache &)).
+    //
+    // The entries are in sets of WAYS, each set holding the keys that map
+    // to it, and a set that's full evicts with the CLOCK algorithm: every
+    // hit marks its entry, and the hand of the set skips (and unmarks)
+    // marked entries to evict the first unmarked one. The sets are locked
+    // in stripes, so threads only wait for each other on the same stripe.
+    //
+    // Deals that only differ in suits share an entry. Every entry keeps its
+    // whole key, so deals whose hashes collide are told apart.
+    class OutcomeCache
+    {
+    public:
+        static const std::size_t WAYS = 8;
+        static const std::size_t STRIPES = 64;
+
+        struct Stats
+        {
+            std::uint64_t hits = 0;
+            std::uint64_t misses = 0;
+            std::uint64_t insertions = 0;
+            std::uint64_t evictions = 0;
+
+            double hitRate() const;
+        };
+
+        // room for at least capacity results, rounded up to a power of two
+        // sets.
+        explicit OutcomeCache(std::size_t capacity,
+                              std::pmr::memory_resource *resource = std::pmr::get_default_resource());
+
+        OutcomeCache(const OutcomeCache &) = delete;
+        OutcomeCache &operator=(const OutcomeCache &) = delete;
+
+        // the result stored for key, counted as a hit or a miss.
+        std::optional<GameResult> find(const OutcomeKey &key);
+        // stores result for key, evicting another entry if its set is full.
+        void insert(const OutcomeKey &key, const GameResult &result);
+
+        // summed over the stripes, each read under its lock.
+        Stats stats() const;
+        std::size_t capacity() const { return sets_.size() * WAYS; }
+        // results currently stored.
+        std::size_t size() const;
+        void clear();
+
+    private:
+        struct Entry
+        {
+            std::uint64_t hash = 0; // of key, compared first
+            OutcomeKey key;
+            GameResult result;
+            bool used = false;
+            bool referenced = false; // hit since the hand last passed
+        };
+
+        struct alignas(64) Set
+        {
+            std::array<Entry, WAYS> entries;
+            std::uint8_t hand = 0;
+        };
+
+        struct alignas(64) Stripe
+        {
+            mutable std::mutex mutex;
+            Stats stats;
+        };
+
+        alloc::Vector<Set, alloc::Component::Cache> sets_;
+        std::array<Stripe, STRIPES> stripes_;
+
+        std::size_t setOf(std::uint64_t hash) const;
+        Stripe &stripeOf(std::size_t set) { return stripes_[set % STRIPES]; }
+    };
+} // namespace ariel
@@ -0,0 +1,33 @@
+#include "player.hpp"
+
+#include "game_base.hpp"
+
+namespace ariel
+{
+    Player::Player(std::string_view name) : name_(names::intern(name))
+    {
+    }
+
+    bool Player::tryAcquire(std::uint64_t token)
+    {
+        std::uint64_t expected = 0;
+        return owner_.compare_exchange_strong(expected, token, std::memory_order_acq_rel,
+                                              std::memory_order_relaxed);
+    }
+
+    void Player::release(std::uint64_t token)
+    {
+        std::uint64_t expected = token;
+        owner_.compare_exchange_strong(expected, 0, std::memory_order_release, std::memory_order_relaxed);
+    }
+
+    int Player::stacksize() const
+    {
+        return game_ == nullptr ? stack_ : game_->stackSize(seat_);
+    }
+
+    int Player::cardesTaken() const
+    {
+        return game_ == nullptr ? cardsTaken_ : game_->cardsTaken(seat_);
+    }
+}
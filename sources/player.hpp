@@ -1,19 +1,58 @@
 #pragma once
 
-#include <string>
+#include <atomic>
+#include <cstdint>
+#include <string_view>
+
+#include "names.hpp"
 
 namespace ariel
 {
+    class GameBase;
+
+    // A Game binds to its players by reference, so a player can neither be
+    // copied nor moved: its address has to stay valid for as long as a game
+    // refers to it.
+    //
+    // While a game is running the cards live in the game itself (see
+    // BasicGame::Hot), and stacksize() / cardesTaken() read them from there.
+    // When the game releases the player it leaves the final counts behind.
     class Player
     {
     private:
+        names::Id name_;
+        int stack_ = 0;      // as left by the last game that released this player
+        int cardsTaken_ = 0; // likewise
+        const GameBase *game_ = nullptr;
+        int seat_ = 0; // 0 or 1, the player's side in game_
+
+        // token of the game this player is bound to, 0 when free. binding
+        // and releasing are a single compare-exchange each, so games can be
+        // built concurrently from any thread without a global registry.
+        std::atomic<std::uint64_t> owner_{0};
+
+        bool tryAcquire(std::uint64_t token);
+        void release(std::uint64_t token);
+
+        friend class GameBase;
 
     public:
-        Player(std::string name) {};
-        ~Player() {};
+        // the name is interned, see names.hpp.
+        Player(std::string_view name);
 
-        int stacksize() {return 0;};
-        int cardesTaken() {return 0;};
-    };  
-}
+        Player(const Player &) = delete;
+        Player &operator=(const Player &) = delete;
+        Player(Player &&) = delete;
+        Player &operator=(Player &&) = delete;
+        ~Player() = default;
+
+        std::string_view name() const { return names::lookup(name_); }
+        names::Id nameId() const { return name_; }
 
+        int stacksize() const;
+        int cardesTaken() const;
+
+        // whether an unfinished game is currently bound to this player.
+        bool inGame() const { return owner_.load(std::memory_order_acquire) != 0; }
+    };
+}
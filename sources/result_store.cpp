@@ -0,0 +1,274 @@
+#include "result_store.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+
+#include <fcntl.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "dealer.hpp"
+
+namespace ariel
+{
+    struct alignas(64) ResultStore::Header
+    {
+        std::uint64_t magic;
+        std::uint32_t version;
+        std::uint32_t slotSize;
+        std::uint64_t slots; // a power of two
+        std::uint64_t size;  // results stored, only changed under the flock
+        std::uint64_t deals; // dealFingerprint() of the writer
+        std::uint32_t turnCap;
+    };
+
+    struct ResultStore::Slot
+    {
+        std::uint64_t seed;
+        std::uint8_t tag; // 1 + the variant, 0 while the slot is free
+        std::uint8_t ending;
+        std::uint8_t winner;
+        std::uint8_t depths;
+        std::uint32_t turns;
+        std::uint32_t draws;
+        std::array<std::uint32_t, StoredResult::MAX_WAR_DEPTH + 1> warDepths;
+    };
+
+    namespace
+    {
+        const std::uint64_t MAGIC = 0x31544c5345525257ULL; // "WRRESLT1"
+        const std::uint32_t VERSION = 3;
+
+        [[noreturn]] void fail(const std::string &what, const std::string &path)
+        {
+            throw std::runtime_error("result store " + path + ": " + what +
+                                     (errno != 0 ? std::string(" (") + std::strerror(errno) + ")" : ""));
+        }
+
+        std::size_t home(Variant variant, std::uint64_t seed)
+        {
+            // splitmix64's finalizer, so consecutive seeds land far apart.
+            std::uint64_t z = seed + (static_cast<std::uint64_t>(variant) + 1) * 0x9e3779b97f4a7c15ULL;
+            z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+            z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+            return static_cast<std::size_t>(z ^ (z >> 31));
+        }
+
+        // the deals of a few seeds, hashed. the results are keyed by seed, but
+        // the deal of a seed depends on the standard library's std::shuffle
+        // (see shuffledDeck()), so a store written by a build with another
+        // one holds the results of other games.
+        std::uint64_t dealFingerprint()
+        {
+            static const std::uint64_t fingerprint = []() {
+                std::uint64_t hash = 0;
+                for (std::uint64_t seed = 0; seed < 4; ++seed)
+                {
+                    for (const std::uint8_t packed : shuffledDeck(seed))
+                    {
+                        std::uint64_t state = hash ^ packed;
+                        hash = splitMix64(state);
+                    }
+                }
+                return hash;
+            }();
+            return fingerprint;
+        }
+
+        std::uint8_t tagOf(Variant variant)
+        {
+            return static_cast<std::uint8_t>(static_cast<std::uint8_t>(variant) + 1);
+        }
+    } // namespace
+
+    ResultStore::ResultStore(const std::string &path, Mode mode, std::size_t capacity, std::uint32_t turnCap)
+        : writable_(mode == Mode::Write)
+    {
+        static_assert(sizeof(Slot) == 128, "two slots per pair of cache lines");
+        errno = 0;
+        fd_ = ::open(path.c_str(), writable_ ? O_RDWR | O_CREAT : O_RDONLY, 0644);
+        if (fd_ < 0)
+        {
+            fail("can't open", path);
+        }
+        try
+        {
+            if (writable_ && ::flock(fd_, LOCK_EX | LOCK_NB) != 0)
+            {
+                fail("already open for writing", path);
+            }
+
+            struct stat status{};
+            if (::fstat(fd_, &status) != 0)
+            {
+                fail("can't stat", path);
+            }
+            const bool created = status.st_size == 0 && writable_;
+            std::size_t slots = 0;
+            if (created)
+            {
+                const double wanted = static_cast<double>(std::max<std::size_t>(capacity, 1)) / MAX_LOAD;
+                slots = std::bit_ceil(static_cast<std::size_t>(wanted) + 1);
+                bytes_ = sizeof(Header) + slots * sizeof(Slot);
+                if (::ftruncate(fd_, static_cast<off_t>(bytes_)) != 0)
+                {
+                    fail("can't resize", path);
+                }
+            }
+            else
+            {
+                bytes_ = static_cast<std::size_t>(status.st_size);
+                if (bytes_ < sizeof(Header))
+                {
+                    errno = 0;
+                    fail("not a result store", path);
+                }
+            }
+
+            const int protection = writable_ ? PROT_READ | PROT_WRITE : PROT_READ;
+            map_ = ::mmap(nullptr, bytes_, protection, MAP_SHARED, fd_, 0);
+            if (map_ == MAP_FAILED)
+            {
+                map_ = nullptr;
+                fail("can't map", path);
+            }
+            header_ = static_cast<Header *>(map_);
+            slots_ = reinterpret_cast<Slot *>(header_ + 1);
+
+            if (created)
+            {
+                // ftruncate() zero filled the slots, which marks them free.
+                *header_ = Header{0, VERSION, sizeof(Slot), slots, 0, dealFingerprint(), turnCap};
+                std::atomic_ref<std::uint64_t>(header_->magic).store(MAGIC, std::memory_order_release);
+            }
+            slots = static_cast<std::size_t>(header_->slots);
+            errno = 0;
+            if (std::atomic_ref<std::uint64_t>(header_->magic).load(std::memory_order_acquire) != MAGIC ||
+                header_->version != VERSION || header_->slotSize != sizeof(Slot) || !std::has_single_bit(slots) ||
+                bytes_ != sizeof(Header) + slots * sizeof(Slot))
+            {
+                fail("not a result store", path);
+            }
+            if (header_->deals != dealFingerprint())
+            {
+                fail("written by a build that deals seeds differently", path);
+            }
+            if (header_->turnCap != turnCap)
+            {
+                fail("holds games capped at " + std::to_string(header_->turnCap) + " turns, not " +
+                         std::to_string(turnCap),
+                     path);
+            }
+            mask_ = slots - 1;
+        }
+        catch (...)
+        {
+            close();
+            throw;
+        }
+    }
+
+    ResultStore::~ResultStore()
+    {
+        close();
+    }
+
+    void ResultStore::close()
+    {
+        if (map_ != nullptr)
+        {
+            if (writable_)
+            {
+                ::msync(map_, bytes_, MS_ASYNC);
+            }
+            ::munmap(map_, bytes_);
+            map_ = nullptr;
+        }
+        if (fd_ >= 0)
+        {
+            ::close(fd_); // drops the flock
+            fd_ = -1;
+        }
+    }
+
+    std::optional<StoredResult> ResultStore::find(Variant variant, std::uint64_t seed) const
+    {
+        const std::uint8_t tag = tagOf(variant);
+        for (std::size_t index = home(variant, seed) & mask_;; index = (index + 1) & mask_)
+        {
+            Slot &slot = slots_[index];
+            const std::uint8_t seen = std::atomic_ref<std::uint8_t>(slot.tag).load(std::memory_order_acquire);
+            if (seen == 0)
+            {
+                return std::nullopt;
+            }
+            if (seen == tag && slot.seed == seed)
+            {
+                StoredResult result;
+                result.ending = static_cast<GameBase::Ending>(slot.ending);
+                result.winner = slot.winner;
+                result.turns = slot.turns;
+                result.draws = slot.draws;
+                result.depths = slot.depths;
+                result.warDepths = slot.warDepths;
+                return result;
+            }
+        }
+    }
+
+    bool ResultStore::insert(Variant variant, std::uint64_t seed, const StoredResult &result)
+    {
+        if (!writable_)
+        {
+            return false;
+        }
+        const std::lock_guard<std::mutex> lock(writer_);
+        const std::uint8_t tag = tagOf(variant);
+        std::size_t index = home(variant, seed) & mask_;
+        for (; slots_[index].tag != 0; index = (index + 1) & mask_)
+        {
+            if (slots_[index].tag == tag && slots_[index].seed == seed)
+            {
+                return true; // the same seed always plays the same game
+            }
+        }
+        if (header_->size + 1 > capacity())
+        {
+            return false;
+        }
+
+        Slot &slot = slots_[index];
+        slot.seed = seed;
+        slot.ending = static_cast<std::uint8_t>(result.ending);
+        slot.winner = result.winner;
+        slot.turns = result.turns;
+        slot.draws = result.draws;
+        slot.depths = result.depths;
+        slot.warDepths = result.warDepths;
+        std::atomic_ref<std::uint8_t>(slot.tag).store(tag, std::memory_order_release);
+        std::atomic_ref<std::uint64_t>(header_->size).fetch_add(1, std::memory_order_relaxed);
+        return true;
+    }
+
+    std::size_t ResultStore::size() const
+    {
+        return static_cast<std::size_t>(
+            std::atomic_ref<std::uint64_t>(header_->size).load(std::memory_order_relaxed));
+    }
+
+    std::uint32_t ResultStore::turnCap() const
+    {
+        return header_->turnCap;
+    }
+
+    std::size_t ResultStore::capacity() const
+    {
+        return static_cast<std::size_t>(static_cast<double>(mask_ + 1) * MAX_LOAD);
+    }
+} // namespace ariel
@@ -0,0 +1,101 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <optional>
+#include <string>
+
+#include "card.hpp"
+#include "game_base.hpp"
+#include "rules.hpp"
+
+namespace ariel
+{
+    // What a batch keeps of a finished game (see runBatch()).
+    struct StoredResult
+    {
+        // a war takes at least two cards from each hand, and a reshuffling
+        // hand holds at most 51 cards.
+        static const std::size_t MAX_WAR_DEPTH = card::DECK_SIZE / 2;
+
+        GameBase::Ending ending = GameBase::Ending::Playing;
+        std::uint8_t winner = 0; // 1 + the winner's seat, 0 if nobody won
+        std::uint32_t turns = 0;
+        std::uint32_t draws = 0;
+        std::uint8_t depths = 0; // entries used in warDepths, as Game::warDepths().size()
+        std::array<std::uint32_t, MAX_WAR_DEPTH + 1> warDepths{};
+    };
+
+    // Results of seeded games in a memory mapped file, keyed by rules
+    // variant and seed, so a run can skip the seeds an earlier one played.
+    //
+    // The file is a header and an open addressing table of fixed size slots,
+    // probed linearly and never deleted from. A lookup reads the mapped slots
+    // in place; nothing is parsed or loaded when the file is opened. The
+    // table doesn't grow: insert() refuses once it's MAX_LOAD full.
+    //
+    // Any number of threads and processes can read the file while one
+    // process writes it. A writer fills a slot before it publishes it by
+    // setting the slot's tag with a release store, and readers load the tag
+    // with acquire, so a reader sees either nothing or the whole result. A
+    // writable store holds an exclusive flock() on the file for its
+    // lifetime; threads of the writing process share it.
+    //
+    // The file is in the byte order of the machine that wrote it. Its header
+    // records how the writer dealt a few seeds, and a build whose standard
+    // library deals them differently refuses the file.
+    class ResultStore
+    {
+    public:
+        enum class Mode
+        {
+            Read,
+            Write // creates the file if it doesn't exist
+        };
+
+        static constexpr double MAX_LOAD = 0.75;
+
+        // opens the store at path. a new file gets room for at least
+        // capacity results; an existing one keeps its own size. reshuffling
+        // games end differently under another turn cap, so the file holds
+        // the games of one cap, recorded when it's created. throws
+        // std::runtime_error if the file can't be opened, mapped or locked,
+        // isn't a result store, was written by a build that deals seeds
+        // differently (see shuffledDeck()) or for another turnCap.
+        ResultStore(const std::string &path, Mode mode, std::size_t capacity = 1 << 16,
+                    std::uint32_t turnCap = DEFAULT_TURN_CAP);
+        ~ResultStore();
+
+        ResultStore(const ResultStore &) = delete;
+        ResultStore &operator=(const ResultStore &) = delete;
+
+        std::optional<StoredResult> find(Variant variant, std::uint64_t seed) const;
+        // stores result unless the seed is already stored; false if the
+        // store is full or read only.
+        bool insert(Variant variant, std::uint64_t seed, const StoredResult &result);
+
+        // results stored, by any writer so far.
+        std::size_t size() const;
+        // results the table takes before insert() refuses.
+        std::size_t capacity() const;
+        // the turn cap of the games stored.
+        std::uint32_t turnCap() const;
+
+    private:
+        struct Header;
+        struct Slot;
+
+        int fd_ = -1;
+        void *map_ = nullptr;
+        std::size_t bytes_ = 0;
+        Header *header_ = nullptr;
+        Slot *slots_ = nullptr;
+        std::size_t mask_ = 0; // slots - 1
+        bool writable_ = false;
+        std::mutex writer_;
+
+        void close();
+    };
+} // namespace ariel
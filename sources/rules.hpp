@@ -0,0 +1,97 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string_view>
+
+// Rule variants of the game, as policies for BasicGame (see game.hpp).
+//
+// A policy is a set of compile time constants. Each BasicGame<Rules> is a
+// separate engine with the rules folded in, so no turn ever branches on a
+// rule flag. Variants derive from ClassicRules and override what differs.
+
+namespace ariel
+{
+    // the README rules: a 2 beats an Ace, one card face down per war, and the
+    // game ends when the dealt stacks run out.
+    struct ClassicRules
+    {
+        // a 2 beats an Ace; otherwise the Ace is simply the highest card.
+        static constexpr bool TWO_BEATS_ACE = true;
+        // cards each player puts face down before the next face up card of
+        // a war.
+        static constexpr unsigned FACE_DOWN = 1;
+        // players shuffle the cards they won back into their stack when it
+        // runs out, and the game goes on until one player holds every card.
+        static constexpr bool RESHUFFLE = false;
+        // with RESHUFFLE, the won cards are shuffled before they are played
+        // again; otherwise they go back in the order they were won, and the
+        // game can loop forever.
+        static constexpr bool SHUFFLE_WON = true;
+    };
+
+    struct AceHighRules : ClassicRules
+    {
+        static constexpr bool TWO_BEATS_ACE = false;
+    };
+
+    template <unsigned N>
+    struct FaceDownRules : ClassicRules
+    {
+        static_assert(N >= 1, "a war needs at least one face down card");
+        static constexpr unsigned FACE_DOWN = N;
+    };
+
+    // the variant described at the top of Test.cpp: won cards are shuffled
+    // and played again, and a player who can't finish a war loses it.
+    struct ReshuffleRules : ClassicRules
+    {
+        static constexpr bool RESHUFFLE = true;
+    };
+
+    // reshuffling without the shuffle: once dealt, the game is fully
+    // determined and often cycles, see BasicGame::ending().
+    struct RecycleRules : ReshuffleRules
+    {
+        static constexpr bool SHUFFLE_WON = false;
+    };
+
+    // a reshuffling game that has neither ended nor cycled stops after this
+    // many turns, unless told otherwise.
+    constexpr std::uint32_t DEFAULT_TURN_CAP = 100000;
+
+    // the instantiated variants, for choosing one at run time (see
+    // BatchOptions).
+    enum class Variant : std::uint8_t
+    {
+        Classic,
+        AceHigh,
+        FaceDown2,
+        FaceDown3,
+        Reshuffle,
+        Recycle
+    };
+
+    constexpr std::array<std::string_view, 6> VARIANT_NAMES = {"classic", "acehigh", "facedown2",
+                                                               "facedown3", "reshuffle", "recycle"};
+
+    constexpr std::string_view variantName(Variant variant)
+    {
+        return VARIANT_NAMES[static_cast<std::size_t>(variant)];
+    }
+
+    // the variant called name, if there is one.
+    constexpr std::optional<Variant> parseVariant(std::string_view name)
+    {
+        for (std::size_t i = 0; i < VARIANT_NAMES.size(); ++i)
+        {
+            if (VARIANT_NAMES[i] == name)
+            {
+                return static_cast<Variant>(i);
+            }
+        }
+        return std::nullopt;
+    }
+} // namespace ariel
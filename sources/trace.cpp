@@ -0,0 +1,194 @@
+#include "trace.hpp"
+
+#include <atomic>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace ariel
+{
+    namespace trace
+    {
+        namespace
+        {
+            const std::size_t BUFFER_EVENTS = std::size_t{1} << 16;
+
+            struct Event
+            {
+                const char *name;
+                std::int64_t begin;
+                std::int64_t end;
+            };
+
+            // single producer (the owning thread), read by writeJson().
+            // size is published with release so a reader never sees a half
+            // written event.
+            struct Buffer
+            {
+                std::vector<Event> events = std::vector<Event>(BUFFER_EVENTS);
+                std::atomic<std::size_t> size{0};
+                std::atomic<std::uint64_t> dropped{0};
+                std::string threadName;
+                int tid = 0;
+            };
+
+            struct Registry
+            {
+                std::mutex mutex;
+                std::vector<std::shared_ptr<Buffer>> buffers;
+                int nextTid = 1;
+            };
+
+            Registry &registry()
+            {
+                static Registry reg;
+                return reg;
+            }
+
+            const std::chrono::steady_clock::time_point &epoch()
+            {
+                static const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+                return start;
+            }
+
+            Buffer &localBuffer()
+            {
+                thread_local std::shared_ptr<Buffer> buffer = [] {
+                    auto created = std::make_shared<Buffer>();
+                    Registry &reg = registry();
+                    const std::lock_guard<std::mutex> lock(reg.mutex);
+                    created->tid = reg.nextTid++;
+                    reg.buffers.push_back(created);
+                    return created;
+                }();
+                return *buffer;
+            }
+
+            void writeEscaped(std::ostream &out, const std::string &text)
+            {
+                for (char chr : text)
+                {
+                    if (chr == '"' || chr == '\\')
+                    {
+                        out << '\\';
+                    }
+                    out << chr;
+                }
+            }
+
+            // trace_event timestamps are microseconds.
+            void writeMicros(std::ostream &out, std::int64_t nanos)
+            {
+                const std::int64_t thousand = 1000;
+                out << nanos / thousand << '.';
+                const std::int64_t frac = nanos % thousand;
+                if (frac < 100)
+                {
+                    out << '0';
+                }
+                if (frac < 10)
+                {
+                    out << '0';
+                }
+                out << frac;
+            }
+        } // namespace
+
+        std::int64_t now()
+        {
+            const auto elapsed = std::chrono::steady_clock::now() - epoch();
+            return std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count();
+        }
+
+        void record(const char *name, std::int64_t begin, std::int64_t end)
+        {
+            Buffer &buffer = localBuffer();
+            const std::size_t index = buffer.size.load(std::memory_order_relaxed);
+            if (index >= buffer.events.size())
+            {
+                buffer.dropped.fetch_add(1, std::memory_order_relaxed);
+                return;
+            }
+            buffer.events[index] = Event{name, begin, end};
+            buffer.size.store(index + 1, std::memory_order_release);
+        }
+
+        void setThreadName(const std::string &name)
+        {
+            if (!enabled)
+            {
+                return;
+            }
+            Buffer &buffer = localBuffer();
+            const std::lock_guard<std::mutex> lock(registry().mutex);
+            buffer.threadName = name;
+        }
+
+        void writeJson(std::ostream &out)
+        {
+            Registry &reg = registry();
+            const std::lock_guard<std::mutex> lock(reg.mutex);
+
+            out << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[";
+            bool first = true;
+            auto separator = [&]() {
+                if (!first)
+                {
+                    out << ",\n";
+                }
+                first = false;
+            };
+
+            for (const auto &buffer : reg.buffers)
+            {
+                if (!buffer->threadName.empty())
+                {
+                    separator();
+                    out << R"({"name":"thread_name","ph":"M","pid":1,"tid":)" << buffer->tid
+                        << R"(,"args":{"name":")";
+                    writeEscaped(out, buffer->threadName);
+                    out << "\"}}";
+                }
+
+                const std::size_t size = buffer->size.load(std::memory_order_acquire);
+                for (std::size_t i = 0; i < size; ++i)
+                {
+                    const Event &event = buffer->events[i];
+                    separator();
+                    out << R"({"name":")";
+                    writeEscaped(out, event.name);
+                    out << R"(","cat":"ariel","ph":"X","pid":1,"tid":)" << buffer->tid << ",\"ts\":";
+                    writeMicros(out, event.begin);
+                    out << ",\"dur\":";
+                    writeMicros(out, event.end - event.begin);
+                    out << '}';
+                }
+            }
+            out << "]}\n";
+        }
+
+        bool writeJson(const std::string &path)
+        {
+            std::ofstream out(path);
+            if (!out)
+            {
+                return false;
+            }
+            writeJson(out);
+            return static_cast<bool>(out);
+        }
+
+        std::uint64_t dropped()
+        {
+            Registry &reg = registry();
+            const std::lock_guard<std::mutex> lock(reg.mutex);
+            std::uint64_t total = 0;
+            for (const auto &buffer : reg.buffers)
+            {
+                total += buffer->dropped.load(std::memory_order_relaxed);
+            }
+            return total;
+        }
+    } // namespace trace
+} // namespace ariel
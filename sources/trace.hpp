@@ -0,0 +1,71 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <ostream>
+#include <string>
+
+// Lightweight phase tracing that dumps Chrome trace_event JSON (open it in
+// https://ui.perfetto.dev or chrome://tracing).
+//
+// Tracing is compiled in only when ARIEL_TRACE is defined (make TRACE=1).
+// Otherwise ARIEL_TRACE_SCOPE expands to nothing and costs nothing.
+//
+// Every thread records into its own fixed-size buffer without locking; the
+// buffer is registered once, the first time the thread records an event.
+// Events that don't fit in the buffer are dropped and counted.
+
+namespace ariel
+{
+    namespace trace
+    {
+#ifdef ARIEL_TRACE
+        constexpr bool enabled = true;
+#else
+        constexpr bool enabled = false;
+#endif
+
+        // nanoseconds since the trace epoch (first use in the process).
+        std::int64_t now();
+
+        // records a complete ("X") event on the calling thread's buffer.
+        // name must have static storage duration.
+        void record(const char *name, std::int64_t begin, std::int64_t end);
+
+        // names the calling thread in the trace viewer.
+        void setThreadName(const std::string &name);
+
+        // writes every recorded event as Chrome trace JSON.
+        void writeJson(std::ostream &out);
+        bool writeJson(const std::string &path);
+
+        // events lost because a thread's buffer was full.
+        std::uint64_t dropped();
+
+        class Scope
+        {
+        private:
+            const char *name_;
+            std::int64_t begin_;
+
+        public:
+            explicit Scope(const char *name) : name_(name), begin_(now()) {}
+            ~Scope() { record(name_, begin_, now()); }
+
+            Scope(const Scope &) = delete;
+            Scope &operator=(const Scope &) = delete;
+            Scope(Scope &&) = delete;
+            Scope &operator=(Scope &&) = delete;
+        };
+    } // namespace trace
+} // namespace ariel
+
+#define ARIEL_TRACE_CONCAT_IMPL(a, b) a##b
+#define ARIEL_TRACE_CONCAT(a, b) ARIEL_TRACE_CONCAT_IMPL(a, b)
+
+#ifdef ARIEL_TRACE
+#define ARIEL_TRACE_SCOPE(name) \
+    const ::ariel::trace::Scope ARIEL_TRACE_CONCAT(ariel_trace_scope_, __LINE__) { name }
+#else
+#define ARIEL_TRACE_SCOPE(name) static_cast<void>(0)
+#endif
@@ -0,0 +1,184 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+#include "card.hpp"
+#include "rules.hpp"
+
+// The rules of a single turn, on two hands of packed cards (see
+// card::packed()).
+//
+// Both players always put down the same number of cards, so both hands have
+// the same length and one index, drawn, says how much of each has been
+// played. Game keeps the hands in one array; the functions here only see the
+// two runs of cards, so they can be tested on hands of any length.
+//
+// Everything here is constexpr, so a whole game can be played at compile
+// time, which also keeps allocation and I/O out of the turn loop.
+
+namespace ariel
+{
+    namespace turn
+    {
+        const int ACE_RANK = card::MAX_RANK - card::MIN_RANK;
+
+        // same sign as card::compare() under Rules, on packed cards, without
+        // branches: the rank difference is only +-ACE_RANK for a 2 against
+        // an Ace.
+        template <typename Rules = ClassicRules>
+        constexpr int compare(std::uint8_t mine, std::uint8_t theirs)
+        {
+            const int diff = mine / card::SUITS - theirs / card::SUITS;
+            if constexpr (Rules::TWO_BEATS_ACE)
+            {
+                const int twoOnAce = diff == -ACE_RANK ? 1 : diff;
+                return diff == ACE_RANK ? -1 : twoOnAce;
+            }
+            else
+            {
+                return diff;
+            }
+        }
+
+        struct Result
+        {
+            unsigned drawn; // cards of each hand played after this turn
+            unsigned potSize;
+            unsigned wars; // ties in this turn
+            int compare;   // of the last face up pair: > 0 first wins, < 0 second wins
+            bool split;    // ran out of cards on a tie, each player takes back half
+        };
+
+        // std::memcpy(to, from, count), which isn't constexpr.
+        constexpr void copyCards(std::uint8_t *to, const std::uint8_t *from, unsigned count)
+        {
+            if (std::is_constant_evaluated())
+            {
+                std::copy_n(from, count, to);
+            }
+            else
+            {
+                std::memcpy(to, from, count);
+            }
+        }
+
+        // distance between two face up pairs in the pot.
+        template <typename Rules = ClassicRules>
+        constexpr unsigned faceUpStride()
+        {
+            return 2 + 2 * Rules::FACE_DOWN;
+        }
+
+        // plays one turn from position drawn of both hands, which hold hand
+        // cards each, and writes every card put down to pot, which must have
+        // room for 2 * (hand + Rules::FACE_DOWN) cards. the pot is a sequence
+        // of groups, each the first player's cards followed by the second
+        // player's: the face up pair, then for every tie the face down cards
+        // and the next face up pair. when a tie leaves fewer cards than a war
+        // needs, each player throws the rest of their hand as a last group.
+        // onFaceUp(mine, theirs) is called for every face up pair, in order.
+        template <typename Rules = ClassicRules, typename OnFaceUp>
+        constexpr Result play(const std::uint8_t *first, const std::uint8_t *second, unsigned hand, unsigned drawn,
+                    std::uint8_t *pot, OnFaceUp &&onFaceUp)
+        {
+            const unsigned down = Rules::FACE_DOWN;
+            unsigned size = 0;
+            unsigned wars = 0;
+            int result = 0;
+            bool war = false;
+
+            do
+            {
+                const std::uint8_t mine = first[drawn];
+                const std::uint8_t theirs = second[drawn];
+                pot[size] = mine;
+                pot[size + 1] = theirs;
+                onFaceUp(mine, theirs);
+                result = compare<Rules>(mine, theirs);
+                const bool tie = result == 0;
+                wars += tie;
+                ++drawn;
+                size += 2;
+
+                war = tie & (hand - drawn >= down + 1);
+                if constexpr (down == 1)
+                {
+                    // the face down pair is always written but only kept when
+                    // there is a war, so the loop body has no branches.
+                    const unsigned faceDown = drawn - 1 + war;
+                    pot[size] = first[faceDown];
+                    pot[size + 1] = second[faceDown];
+                    drawn += war;
+                    size += 2 * unsigned{war};
+                }
+                else if (war)
+                {
+                    copyCards(pot + size, first + drawn, down);
+                    copyCards(pot + size + down, second + drawn, down);
+                    drawn += down;
+                    size += 2 * down;
+                }
+            } while (war);
+
+            const bool split = result == 0;
+            if (split)
+            {
+                // end of the deck: both throw the rest of their hand as it is.
+                const unsigned rest = hand - drawn;
+                copyCards(pot + size, first + drawn, rest);
+                copyCards(pot + size + rest, second + drawn, rest);
+                size += 2 * rest;
+                drawn = hand;
+            }
+            return Result{drawn, size, wars, result, split};
+        }
+
+        template <typename Rules = ClassicRules>
+        constexpr Result play(const std::uint8_t *first, const std::uint8_t *second, unsigned hand, unsigned drawn,
+                              std::uint8_t *pot)
+        {
+            return play<Rules>(first, second, hand, drawn, pot, [](std::uint8_t, std::uint8_t) {});
+        }
+
+        // the counters of a whole game without reshuffling.
+        struct Tally
+        {
+            std::array<unsigned, 2> taken{};
+            unsigned turns = 0;
+            unsigned wars = 0;
+            unsigned splits = 0; // turns that ran out of cards on a tie
+
+            // 1 + the seat that took more cards, 0 on a tie.
+            constexpr unsigned winner() const { return taken[0] == taken[1] ? 0 : (taken[0] > taken[1] ? 1 : 2); }
+            constexpr bool operator==(const Tally &) const = default;
+        };
+
+        // plays hands of hand cards (at most DECK_SIZE / 2) to the end, turn
+        // by turn as a game without reshuffling does, taking cards like
+        // BasicGame: half the pot to the winner, the cards won from the
+        // other, and on a split each player's own half back.
+        template <typename Rules = ClassicRules>
+        constexpr Tally playOut(const std::uint8_t *first, const std::uint8_t *second, unsigned hand)
+        {
+            std::array<std::uint8_t, card::DECK_SIZE + 2 * Rules::FACE_DOWN> pot;
+            Tally tally;
+            for (unsigned drawn = 0; drawn < hand;)
+            {
+                const Result played = play<Rules>(first, second, hand, drawn, pot.data());
+                const unsigned half = played.potSize / 2;
+                tally.taken[0] += half * static_cast<unsigned>(played.split || played.compare > 0);
+                tally.taken[1] += half * static_cast<unsigned>(played.split || played.compare < 0);
+                ++tally.turns;
+                tally.wars += played.wars;
+                tally.splits += played.split;
+                drawn = played.drawn;
+            }
+            return tally;
+        }
+    } // namespace turn
+} // namespace ariel